@@ -1,32 +1,150 @@
 #include <GL/glut.h>
 #include <iostream>
 #include <cmath>
+#include <climits>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "framebuffer.h"
+#include "thread_pool.h"
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 using namespace std;
 
 // Fixed variable names
 int x_start = -6, y_start = 13;
 int x_end = 8, y_end = 2;
 
+// World window shown by gluOrtho2D
+const int WINDOW_XMIN = -10, WINDOW_XMAX = 10;
+const int WINDOW_YMIN = -5, WINDOW_YMAX = 15;
+
+// Pixel sink that forwards every pixel to OpenGL; callers wrap it in
+// glBegin(GL_POINTS) / glEnd(). Framebuffer (framebuffer.h) is the
+// headless sink with the same plot(x, y) interface.
+struct GLPointSink {
+    void plot(int x, int y) { glVertex2i(x, y); }
+    void hspan(int y, int xa, int xb) {
+        for (int x = min(xa, xb); x <= max(xa, xb); x++) glVertex2i(x, y);
+    }
+    void vspan(int x, int ya, int yb) {
+        for (int y = min(ya, yb); y <= max(ya, yb); y++) glVertex2i(x, y);
+    }
+};
+
 // Function to draw a line using DDA algorithm
-void drawLineDDA(int x0, int y0, int x1, int y1) {
+template <typename Sink>
+void drawLineDDA(int x0, int y0, int x1, int y1, Sink& sink) {
     int dx = x1 - x0;
     int dy = y1 - y0;
     int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+    if (steps == 0) { sink.plot(x0, y0); return; }
     float x_inc = dx / (float)steps;
     float y_inc = dy / (float)steps;
     float x = x0;
     float y = y0;
+    for (int i = 0; i <= steps; i++) {
+        sink.plot(round(x), round(y));
+        x += x_inc;
+        y += y_inc;
+    }
+}
+
+void drawLineDDA(int x0, int y0, int x1, int y1) {
+    GLPointSink sink;
     glBegin(GL_POINTS);
+    drawLineDDA(x0, y0, x1, y1, sink);
+    glEnd();
+}
+
+// 16.16 fixed-point DDA. Positions carry 16 fraction bits in 64-bit
+// integers so coordinates and lengths beyond 32k cannot overflow. The
+// per-step increment is rounded rather than truncated: after n steps the
+// error stays under n/2 units of 2^-16, so the last pixel lands exactly
+// on (x1, y1) for every line up to 65535 steps. The +0.5 bias folded
+// into the start point turns the shift into round-half-up.
+const int DDA_FRACTION_BITS = 16;
+const long long DDA_ONE = 1LL << DDA_FRACTION_BITS;
+
+long long ddaFixedIncrement(int delta, int steps) {
+    long long n = delta * DDA_ONE;
+    return (n + (n >= 0 ? steps / 2 : -(steps / 2))) / steps;
+}
+
+template <typename Sink>
+void drawLineDDAFixed(int x0, int y0, int x1, int y1, Sink& sink) {
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+    if (steps == 0) { sink.plot(x0, y0); return; }
+    long long x_inc = ddaFixedIncrement(dx, steps);
+    long long y_inc = ddaFixedIncrement(dy, steps);
+    long long x = x0 * DDA_ONE + DDA_ONE / 2;
+    long long y = y0 * DDA_ONE + DDA_ONE / 2;
     for (int i = 0; i <= steps; i++) {
-        glVertex2i(round(x), round(y));
+        sink.plot((int)(x >> DDA_FRACTION_BITS), (int)(y >> DDA_FRACTION_BITS));
         x += x_inc;
         y += y_inc;
     }
+}
+
+void drawLineDDAFixed(int x0, int y0, int x1, int y1) {
+    GLPointSink sink;
+    glBegin(GL_POINTS);
+    drawLineDDAFixed(x0, y0, x1, y1, sink);
     glEnd();
 }
 
+// drawLineDDAFixed clipped to [xmin, xmax] x [ymin, ymax] before
+// rasterizing. The fixed-point position after i steps is exactly
+// p0 + i * inc, so the steps whose pixel lies inside the window form one
+// index range per axis, found by division. The walk covers only their
+// intersection and is pixel-identical to the unclipped line with
+// off-window pixels discarded.
+template <typename Sink>
+void drawLineDDAFixedClipped(int x0, int y0, int x1, int y1,
+                             int xmin, int ymin, int xmax, int ymax, Sink& sink) {
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+    long long x_inc = steps ? ddaFixedIncrement(dx, steps) : 0;
+    long long y_inc = steps ? ddaFixedIncrement(dy, steps) : 0;
+    long long x = x0 * DDA_ONE + DDA_ONE / 2;
+    long long y = y0 * DDA_ONE + DDA_ONE / 2;
+
+    auto floorDiv = [](long long a, long long b) {
+        long long q = a / b;
+        return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+    };
+    // Narrows [lo, hi] to the steps whose pixel on this axis is in [wmin, wmax]
+    auto clipAxis = [&](long long p0, long long inc, int wmin, int wmax, long long& lo, long long& hi) {
+        long long first = wmin * DDA_ONE - p0, last = wmax * DDA_ONE + DDA_ONE - 1 - p0;
+        if (inc == 0) {
+            if (first > 0 || last < 0) hi = -1;
+            return;
+        }
+        if (inc < 0) swap(first, last);
+        lo = max(lo, -floorDiv(-first, inc));
+        hi = min(hi, floorDiv(last, inc));
+    };
+    long long lo = 0, hi = steps;
+    clipAxis(x, x_inc, xmin, xmax, lo, hi);
+    clipAxis(y, y_inc, ymin, ymax, lo, hi);
+
+    x += lo * x_inc;
+    y += lo * y_inc;
+    for (long long i = lo; i <= hi; i++) {
+        sink.plot((int)(x >> DDA_FRACTION_BITS), (int)(y >> DDA_FRACTION_BITS));
+        x += x_inc;
+        y += y_inc;
+    }
+}
+
 // Function to draw a line using Bresenham's algorithm
-void drawLineBresenham(int x0, int y0, int x1, int y1) {
+template <typename Sink>
+void drawLineBresenham(int x0, int y0, int x1, int y1, Sink& sink) {
     int dx = abs(x1 - x0);
     int dy = abs(y1 - y0);
     int x = x0;
@@ -34,17 +152,438 @@ void drawLineBresenham(int x0, int y0, int x1, int y1) {
     int sx = (x0 < x1) ? 1 : -1;
     int sy = (y0 < y1) ? 1 : -1;
     int err = dx - dy;
-    glBegin(GL_POINTS);
     while (true) {
-        glVertex2i(x, y);
+        sink.plot(x, y);
         if (x == x1 && y == y1) break;
         int e2 = 2 * err;
         if (e2 > -dy) { err -= dy; x += sx; }
         if (e2 < dx) { err += dx; y += sy; }
     }
+}
+
+void drawLineBresenham(int x0, int y0, int x1, int y1) {
+    GLPointSink sink;
+    glBegin(GL_POINTS);
+    drawLineBresenham(x0, y0, x1, y1, sink);
     glEnd();
 }
 
+// ---------------------------------------------------------------------
+// Batch Bresenham: steps several lines at once, one line per SIMD lane.
+// Each lane runs the exact drawLineBresenham recurrence (err, e2 and the
+// two comparisons), so the batch writes the same pixels as the scalar
+// function. Uses 8 AVX2 lanes when built with -mavx2, otherwise 4 SSE2
+// lanes, and plain scalar calls when neither is available.
+// ---------------------------------------------------------------------
+
+#if defined(__AVX2__)
+struct LineLanes {
+    typedef __m256i V;
+    static const int N = 8;
+    static V load(const int* p) { return _mm256_load_si256((const V*)p); }
+    static void store(int* p, V v) { _mm256_store_si256((V*)p, v); }
+    static V set1(int v) { return _mm256_set1_epi32(v); }
+    static V add(V a, V b) { return _mm256_add_epi32(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_epi32(a, b); }
+    static V mask(V a, V m) { return _mm256_and_si256(a, m); }
+    static V both(V a, V b) { return _mm256_and_si256(a, b); }
+    static V gt(V a, V b) { return _mm256_cmpgt_epi32(a, b); }
+    static V shr16(V a) { return _mm256_srai_epi32(a, 16); }
+    static int bits(V m) { return _mm256_movemask_ps(_mm256_castsi256_ps(m)); }
+};
+#elif defined(__SSE2__)
+struct LineLanes {
+    typedef __m128i V;
+    static const int N = 4;
+    static V load(const int* p) { return _mm_load_si128((const V*)p); }
+    static void store(int* p, V v) { _mm_store_si128((V*)p, v); }
+    static V set1(int v) { return _mm_set1_epi32(v); }
+    static V add(V a, V b) { return _mm_add_epi32(a, b); }
+    static V sub(V a, V b) { return _mm_sub_epi32(a, b); }
+    static V mask(V a, V m) { return _mm_and_si128(a, m); }
+    static V both(V a, V b) { return _mm_and_si128(a, b); }
+    static V gt(V a, V b) { return _mm_cmpgt_epi32(a, b); }
+    static V shr16(V a) { return _mm_srai_epi32(a, 16); }
+    static int bits(V m) { return _mm_movemask_ps(_mm_castsi128_ps(m)); }
+};
+#endif
+
+#if defined(__SSE2__) || defined(__AVX2__)
+// Rasterizes LineLanes::N lines starting at index first
+void drawLineGroupBresenham(const int* x0, const int* y0, const int* x1, const int* y1,
+                            int first, Framebuffer& fb) {
+    typedef LineLanes L;
+    alignas(32) int lx[L::N], ly[L::N], ldx[L::N], ldy[L::N];
+    alignas(32) int lsx[L::N], lsy[L::N], lerr[L::N], lsteps[L::N];
+    int maxSteps = 0;
+    for (int k = 0; k < L::N; k++) {
+        int i = first + k;
+        lx[k] = x0[i] - fb.originX;
+        ly[k] = y0[i] - fb.originY;
+        ldx[k] = abs(x1[i] - x0[i]);
+        ldy[k] = abs(y1[i] - y0[i]);
+        lsx[k] = (x0[i] < x1[i]) ? 1 : -1;
+        lsy[k] = (y0[i] < y1[i]) ? 1 : -1;
+        lerr[k] = ldx[k] - ldy[k];
+        lsteps[k] = max(ldx[k], ldy[k]);
+        maxSteps = max(maxSteps, lsteps[k]);
+    }
+
+    L::V x = L::load(lx), y = L::load(ly);
+    L::V dx = L::load(ldx), dy = L::load(ldy);
+    L::V negDy = L::sub(L::set1(0), dy);
+    L::V sx = L::load(lsx), sy = L::load(lsy);
+    L::V err = L::load(lerr), steps = L::load(lsteps);
+    const L::V minusOne = L::set1(-1), one = L::set1(1);
+    const L::V width = L::set1(fb.width), height = L::set1(fb.height);
+    uint32_t* pixels = fb.pixels.data();
+
+    for (int s = 0; s <= maxSteps; s++) {
+        // Masked write: lanes that still have pixels left and are on screen
+        L::V visible = L::both(L::both(L::gt(steps, minusOne), L::gt(x, minusOne)),
+                               L::both(L::gt(width, x),
+                                       L::both(L::gt(y, minusOne), L::gt(height, y))));
+        int m = L::bits(visible);
+        if (m) {
+            L::store(lx, x);
+            L::store(ly, y);
+            while (m) {
+                int k = __builtin_ctz(m);
+                pixels[(size_t)ly[k] * fb.width + lx[k]] = fb.color;
+                m &= m - 1;
+            }
+        }
+        L::V e2 = L::add(err, err);
+        L::V stepX = L::gt(e2, negDy);
+        err = L::sub(err, L::mask(dy, stepX));
+        x = L::add(x, L::mask(sx, stepX));
+        L::V stepY = L::gt(dx, e2);
+        err = L::add(err, L::mask(dx, stepY));
+        y = L::add(y, L::mask(sy, stepY));
+        steps = L::sub(steps, one);
+    }
+}
+#endif
+
+// Batch API: line i runs from (x0[i], y0[i]) to (x1[i], y1[i])
+void drawLinesBresenhamBatch(const int* x0, const int* y0, const int* x1, const int* y1,
+                             int count, Framebuffer& fb) {
+    int i = 0;
+#if defined(__SSE2__) || defined(__AVX2__)
+    for (; i + LineLanes::N <= count; i += LineLanes::N) {
+        drawLineGroupBresenham(x0, y0, x1, y1, i, fb);
+    }
+#endif
+    for (; i < count; i++) {
+        drawLineBresenham(x0[i], y0[i], x1[i], y1[i], fb);
+    }
+}
+
+// Wide fixed-point DDA: emits LineLanes::N consecutive pixels per step.
+// The 64-bit position is split into an integer base and a 16-bit
+// fraction; because |increment| <= 1.0, fraction + k * increment fits in
+// 32 bits for every lane k, so one arithmetic shift per lane recovers the
+// same pixel the scalar drawLineDDAFixed produces. It is slower than the
+// scalar loop, though: the pixel writes are still one scalar store per
+// lane, and moving the lanes out of the vector to make them costs more
+// than the shifts it saves. --bench reports both.
+void drawLineDDAFixedWide(int x0, int y0, int x1, int y1, Framebuffer& fb) {
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
+#if defined(__SSE2__) || defined(__AVX2__)
+    typedef LineLanes L;
+    if (steps < L::N) {
+        drawLineDDAFixed(x0, y0, x1, y1, fb);
+        return;
+    }
+    long long x_inc = ddaFixedIncrement(dx, steps);
+    long long y_inc = ddaFixedIncrement(dy, steps);
+    long long x = x0 * DDA_ONE + DDA_ONE / 2 - fb.originX * DDA_ONE;
+    long long y = y0 * DDA_ONE + DDA_ONE / 2 - fb.originY * DDA_ONE;
+    alignas(32) int lanes[L::N], lx[L::N], ly[L::N];
+    for (int k = 0; k < L::N; k++) lanes[k] = k;
+    const L::V laneIndex = L::load(lanes);
+    for (int k = 0; k < L::N; k++) lanes[k] = (int)(k * x_inc);
+    const L::V xOffsets = L::load(lanes);
+    for (int k = 0; k < L::N; k++) lanes[k] = (int)(k * y_inc);
+    const L::V yOffsets = L::load(lanes);
+    const L::V minusOne = L::set1(-1), fraction = L::set1((int)(DDA_ONE - 1));
+    const L::V width = L::set1(fb.width), height = L::set1(fb.height);
+    uint32_t* pixels = fb.pixels.data();
+
+    for (int i = 0; i <= steps; i += L::N) {
+        L::V px = L::add(L::set1((int)(x >> DDA_FRACTION_BITS)),
+                         L::shr16(L::add(L::mask(L::set1((int)x), fraction), xOffsets)));
+        L::V py = L::add(L::set1((int)(y >> DDA_FRACTION_BITS)),
+                         L::shr16(L::add(L::mask(L::set1((int)y), fraction), yOffsets)));
+        L::V visible = L::both(L::both(L::gt(L::set1(steps - i + 1), laneIndex), L::gt(px, minusOne)),
+                               L::both(L::gt(width, px),
+                                       L::both(L::gt(py, minusOne), L::gt(height, py))));
+        int m = L::bits(visible);
+        if (m) {
+            L::store(lx, px);
+            L::store(ly, py);
+            while (m) {
+                int k = __builtin_ctz(m);
+                pixels[(size_t)ly[k] * fb.width + lx[k]] = fb.color;
+                m &= m - 1;
+            }
+        }
+        x += L::N * x_inc;
+        y += L::N * y_inc;
+    }
+#else
+    (void)steps;
+    drawLineDDAFixed(x0, y0, x1, y1, fb);
+#endif
+}
+
+// Octant-specialized Bresenham. The step signs and the major axis are
+// template parameters, so after one dispatch per line the inner loop has
+// a fixed trip count and no sign tests. The major axis steps on every
+// pixel, and the minor step is applied through a mask instead of a branch.
+// The decision is the same e2 comparison drawLineBresenham uses, so the
+// pixels are identical.
+template <int SX, int SY, bool XMajor, typename Sink>
+void drawLineOctantKernel(int x, int y, int dx, int dy, Sink& sink) {
+    int err = dx - dy;
+    int steps = XMajor ? dx : dy;
+    for (int i = 0; i <= steps; i++) {
+        sink.plot(x, y);
+        int e2 = 2 * err;
+        if (XMajor) {
+            int step = -(e2 < dx);
+            err += (dx & step) - dy;
+            x += SX;
+            y += SY & step;
+        } else {
+            int step = -(e2 > -dy);
+            err += dx - (dy & step);
+            x += SX & step;
+            y += SY;
+        }
+    }
+}
+
+template <typename Sink>
+void drawLineBresenhamOctant(int x0, int y0, int x1, int y1, Sink& sink) {
+    int dx = abs(x1 - x0);
+    int dy = abs(y1 - y0);
+    int octant = (dx >= dy ? 0 : 4) | (x0 < x1 ? 0 : 2) | (y0 < y1 ? 0 : 1);
+    switch (octant) {
+        case 0: drawLineOctantKernel< 1,  1, true>(x0, y0, dx, dy, sink); break;
+        case 1: drawLineOctantKernel< 1, -1, true>(x0, y0, dx, dy, sink); break;
+        case 2: drawLineOctantKernel<-1,  1, true>(x0, y0, dx, dy, sink); break;
+        case 3: drawLineOctantKernel<-1, -1, true>(x0, y0, dx, dy, sink); break;
+        case 4: drawLineOctantKernel< 1,  1, false>(x0, y0, dx, dy, sink); break;
+        case 5: drawLineOctantKernel< 1, -1, false>(x0, y0, dx, dy, sink); break;
+        case 6: drawLineOctantKernel<-1,  1, false>(x0, y0, dx, dy, sink); break;
+        case 7: drawLineOctantKernel<-1, -1, false>(x0, y0, dx, dy, sink); break;
+    }
+}
+
+void drawLineBresenhamOctant(int x0, int y0, int x1, int y1) {
+    GLPointSink sink;
+    glBegin(GL_POINTS);
+    drawLineBresenhamOctant(x0, y0, x1, y1, sink);
+    glEnd();
+}
+
+// Run-length slice line: same pixels as drawLineBresenham, emitted as
+// whole horizontal (x-major) or vertical (y-major) runs through the sink's
+// hspan / vspan. Along the major axis the Bresenham recurrence above steps
+// the minor axis for the m-th time at major index floor((2m-1)*D/(2d)) + 1,
+// where D and d are the major and minor deltas. Interior runs are therefore
+// q = D / d or q + 1 pixels long, and one division per line plus an
+// error term picks between them.
+template <typename Sink>
+void drawLineRunSlice(int x0, int y0, int x1, int y1, Sink& sink) {
+    int dx = abs(x1 - x0);
+    int dy = abs(y1 - y0);
+    int sx = (x0 < x1) ? 1 : -1;
+    int sy = (y0 < y1) ? 1 : -1;
+    bool xMajor = dx >= dy;
+    int major = xMajor ? dx : dy;
+    int minor = xMajor ? dy : dx;
+
+    // Emits the run of major indices [a, b] at minor index m
+    auto run = [&](int a, int b, int m) {
+        if (xMajor) sink.hspan(y0 + sy * m, x0 + sx * a, x0 + sx * b);
+        else sink.vspan(x0 + sx * m, y0 + sy * a, y0 + sy * b);
+    };
+
+    if (minor == 0) {
+        run(0, major, 0);
+        return;
+    }
+    int q = major / minor;
+    int r = major % minor;
+    // Residue of (2m-1)*major modulo 2*minor, starting at m = 1
+    int residue = (q & 1) ? minor + r : r;
+    int start = q / 2 + 1;
+    run(0, start - 1, 0);
+    for (int m = 1; m < minor; m++) {
+        int length = q;
+        residue += 2 * r;
+        if (residue >= 2 * minor) {
+            residue -= 2 * minor;
+            length++;
+        }
+        run(start, start + length - 1, m);
+        start += length;
+    }
+    run(start, major, minor);
+}
+
+void drawLineRunSlice(int x0, int y0, int x1, int y1) {
+    GLPointSink sink;
+    glBegin(GL_POINTS);
+    drawLineRunSlice(x0, y0, x1, y1, sink);
+    glEnd();
+}
+
+// Bresenham clipped to [xmin, xmax] x [ymin, ymax] before rasterizing.
+// With D and d the major and minor deltas, the recurrence in
+// drawLineBresenham always steps the major axis, and the pixel at major
+// index j sits at minor index m(j) = floor((2jd + D - 1) / 2D). The first
+// pixel of minor index m >= 1 is at J(m) = floor((2m - 1)D / 2d) + 1. The
+// error term there is recomputed exactly, so the walk starts at the entry
+// pixel and stops at the exit pixel. The result is pixel-identical to the
+// unclipped line with off-window pixels discarded. All setup math is
+// 64/128-bit, so endpoints anywhere in the int range are fine.
+template <typename Sink>
+void drawLineBresenhamClipped(int x0, int y0, int x1, int y1,
+                              int xmin, int ymin, int xmax, int ymax, Sink& sink) {
+    if (xmin > xmax || ymin > ymax) return;
+    long long dx = llabs((long long)x1 - x0);
+    long long dy = llabs((long long)y1 - y0);
+    int sx = (x0 < x1) ? 1 : -1;
+    int sy = (y0 < y1) ? 1 : -1;
+    bool xMajor = dx >= dy;
+    long long D = xMajor ? dx : dy;
+    long long d = xMajor ? dy : dx;
+
+    // Index range [lo, hi] along an axis that starts at p0 and steps by s
+    auto axisRange = [](long long p0, int s, int wmin, int wmax, long long& lo, long long& hi) {
+        lo = (s > 0) ? wmin - p0 : p0 - wmax;
+        hi = (s > 0) ? wmax - p0 : p0 - wmin;
+    };
+    long long jlo, jhi, mlo, mhi;
+    if (xMajor) {
+        axisRange(x0, sx, xmin, xmax, jlo, jhi);
+        axisRange(y0, sy, ymin, ymax, mlo, mhi);
+    } else {
+        axisRange(y0, sy, ymin, ymax, jlo, jhi);
+        axisRange(x0, sx, xmin, xmax, mlo, mhi);
+    }
+    jlo = max(jlo, 0LL); jhi = min(jhi, D);
+    mlo = max(mlo, 0LL); mhi = min(mhi, d);
+    if (jlo > jhi || mlo > mhi) return;
+
+    auto firstIndexOfMinor = [&](long long m) -> long long {
+        if (m <= 0) return 0;
+        return (long long)(((__int128)(2 * m - 1) * D) / (2 * d)) + 1;
+    };
+    jlo = max(jlo, firstIndexOfMinor(mlo));
+    if (mhi < d) jhi = min(jhi, firstIndexOfMinor(mhi + 1) - 1);
+    if (jlo > jhi) return;
+
+    long long m = (D == 0) ? 0 : (long long)(((__int128)2 * jlo * d + D - 1) / (2 * D));
+    // jlo * dy and m * dx reach 2^64 for lines across the int range, but
+    // their difference, the error term, stays within [-2D, 2D]
+    long long err = xMajor ? (long long)((__int128)dx - dy - (__int128)jlo * dy + (__int128)m * dx)
+                           : (long long)((__int128)dx - dy + (__int128)jlo * dx - (__int128)m * dy);
+    long long x = x0 + (long long)sx * (xMajor ? jlo : m);
+    long long y = y0 + (long long)sy * (xMajor ? m : jlo);
+    for (long long j = jlo; j <= jhi; j++) {
+        sink.plot((int)x, (int)y);
+        long long e2 = 2 * err;
+        if (e2 > -dy) { err -= dy; x += sx; }
+        if (e2 < dx) { err += dx; y += sy; }
+    }
+}
+
+// Clipped to the framebuffer's own bounds
+void drawLineBresenhamClipped(int x0, int y0, int x1, int y1, Framebuffer& fb) {
+    drawLineBresenhamClipped(x0, y0, x1, y1, fb.originX, fb.originY,
+                             fb.originX + fb.width - 1, fb.originY + fb.height - 1, fb);
+}
+
+void drawLineBresenhamClipped(int x0, int y0, int x1, int y1,
+                              int xmin, int ymin, int xmax, int ymax) {
+    GLPointSink sink;
+    glBegin(GL_POINTS);
+    drawLineBresenhamClipped(x0, y0, x1, y1, xmin, ymin, xmax, ymax, sink);
+    glEnd();
+}
+
+// ---------------------------------------------------------------------
+// Tiled multithreaded renderer. Lines are binned into square screen
+// tiles, and each tile is rasterized by one thread, with its lines
+// clipped to the tile. No two threads ever write the same pixel, so the
+// shared framebuffer needs no locks. A tile replays its lines in scene
+// order, so the image matches a serial render.
+// ---------------------------------------------------------------------
+
+// Scene of line segments in structure-of-arrays form
+struct LineSet {
+    vector<int> x0, y0, x1, y1;
+};
+
+// LINE_DDA is the 16.16 fixed-point DDA, which can be clipped exactly;
+// the float DDA's accumulated position has no closed form to jump to
+enum LineAlgorithm { LINE_DDA, LINE_BRESENHAM };
+
+struct TiledLineRenderer {
+    int tileSize;
+    int tilesX = 0, tilesY = 0;
+    vector<vector<int>> bins; // line indices per tile, reused across frames
+
+    explicit TiledLineRenderer(int size) : tileSize(size) {}
+
+    void bin(const LineSet& lines, const Framebuffer& fb) {
+        tilesX = (fb.width + tileSize - 1) / tileSize;
+        tilesY = (fb.height + tileSize - 1) / tileSize;
+        bins.resize((size_t)tilesX * tilesY);
+        for (auto& tile : bins) tile.clear();
+        for (size_t i = 0; i < lines.x0.size(); i++) {
+            // Bounding box in framebuffer pixels, clamped to the screen
+            int bx0 = min(lines.x0[i], lines.x1[i]) - fb.originX;
+            int bx1 = max(lines.x0[i], lines.x1[i]) - fb.originX;
+            int by0 = min(lines.y0[i], lines.y1[i]) - fb.originY;
+            int by1 = max(lines.y0[i], lines.y1[i]) - fb.originY;
+            if (bx1 < 0 || by1 < 0 || bx0 >= fb.width || by0 >= fb.height) continue;
+            int tx0 = max(bx0, 0) / tileSize, tx1 = min(bx1, fb.width - 1) / tileSize;
+            int ty0 = max(by0, 0) / tileSize, ty1 = min(by1, fb.height - 1) / tileSize;
+            for (int ty = ty0; ty <= ty1; ty++) {
+                for (int tx = tx0; tx <= tx1; tx++) {
+                    bins[(size_t)ty * tilesX + tx].push_back((int)i);
+                }
+            }
+        }
+    }
+
+    void render(const LineSet& lines, LineAlgorithm algorithm, Framebuffer& fb, ThreadPool& pool) {
+        bin(lines, fb);
+        pool.parallelFor(tilesX * tilesY, [&](int tile, int) {
+            int xmin = fb.originX + (tile % tilesX) * tileSize;
+            int ymin = fb.originY + (tile / tilesX) * tileSize;
+            int xmax = min(xmin + tileSize, fb.originX + fb.width) - 1;
+            int ymax = min(ymin + tileSize, fb.originY + fb.height) - 1;
+            for (int i : bins[tile]) {
+                if (algorithm == LINE_BRESENHAM) {
+                    drawLineBresenhamClipped(lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i],
+                                             xmin, ymin, xmax, ymax, fb);
+                } else {
+                    drawLineDDAFixedClipped(lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i],
+                                            xmin, ymin, xmax, ymax, fb);
+                }
+            }
+        });
+    }
+};
+
 // Display function for DDA window
 void displayDDA() {
     glClear(GL_COLOR_BUFFER_BIT);
@@ -79,11 +618,325 @@ void displayBresenham() {
     // Draw Bresenham line
     glColor3f(0.0, 0.0, 1.0); // Blue for Bresenham
     glPointSize(5.0);
-    drawLineBresenham(x_start, y_start, x_end, y_end);
+    drawLineBresenhamClipped(x_start, y_start, x_end, y_end,
+                             WINDOW_XMIN, WINDOW_YMIN, WINDOW_XMAX, WINDOW_YMAX);
     glFlush();
 }
 
+// ---------------------------------------------------------------------
+// Headless mode: rasterize into a Framebuffer without a GL context.
+//   ./output --bench          line throughput of each algorithm
+//   ./output --ppm file.ppm   dump the two demo lines as an image
+// ---------------------------------------------------------------------
+
+// Random short segments inside a width x height framebuffer
+LineSet makeRandomLines(int count, int width, int height, int maxLength, unsigned seed) {
+    mt19937 rng(seed);
+    uniform_int_distribution<int> px(0, width - 1), py(0, height - 1);
+    uniform_int_distribution<int> d(-maxLength, maxLength);
+    LineSet lines;
+    lines.x0.resize(count); lines.y0.resize(count);
+    lines.x1.resize(count); lines.y1.resize(count);
+    for (int i = 0; i < count; i++) {
+        lines.x0[i] = px(rng);
+        lines.y0[i] = py(rng);
+        lines.x1[i] = min(max(lines.x0[i] + d(rng), 0), width - 1);
+        lines.y1[i] = min(max(lines.y0[i] + d(rng), 0), height - 1);
+    }
+    return lines;
+}
+
+double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+long long countLinePixels(const LineSet& lines) {
+    long long total = 0;
+    for (size_t i = 0; i < lines.x0.size(); i++) {
+        total += max(abs(lines.x1[i] - lines.x0[i]), abs(lines.y1[i] - lines.y0[i])) + 1;
+    }
+    return total;
+}
+
+void reportThroughput(const char* name, int lineCount, long long pixels, double seconds) {
+    printf("%-28s %8.2f Mlines/s %9.1f Mpixels/s\n",
+           name, lineCount / seconds / 1e6, pixels / seconds / 1e6);
+}
+
+// Times one line kernel over the whole set, keeping the best of a few runs
+template <typename Kernel>
+void benchLines(const char* name, const LineSet& lines, Framebuffer& fb, Kernel kernel) {
+    int count = (int)lines.x0.size();
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        fb.clear();
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            kernel(lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i], fb);
+        }
+        best = min(best, secondsSince(start));
+    }
+    reportThroughput(name, count, countLinePixels(lines), best);
+}
+
+// Remembers the last pixel a line produced
+struct LastPixelSink {
+    int x = 0, y = 0;
+    long long count = 0;
+    void plot(int px, int py) { x = px; y = py; count++; }
+};
+
+// Counts long lines whose final DDA pixel misses (x1, y1)
+void reportDDAEndpoints() {
+    const int COUNT = 2000;
+    mt19937 rng(7);
+    uniform_int_distribution<int> length(1, 65535), minor(-65535, 65535), coord(-100000, 100000);
+    int floatMisses = 0, fixedMisses = 0;
+    for (int i = 0; i < COUNT; i++) {
+        int x0 = coord(rng), y0 = coord(rng);
+        int major = length(rng), other = minor(rng) % (major + 1);
+        if (rng() & 1) major = -major;
+        bool xMajor = rng() & 1;
+        int x1 = x0 + (xMajor ? major : other), y1 = y0 + (xMajor ? other : major);
+        LastPixelSink last;
+        drawLineDDA(x0, y0, x1, y1, last);
+        floatMisses += (last.x != x1 || last.y != y1);
+        drawLineDDAFixed(x0, y0, x1, y1, last);
+        fixedMisses += (last.x != x1 || last.y != y1);
+    }
+    printf("  endpoint misses on %d lines up to 65535 px: float %d, fixed %d\n",
+           COUNT, floatMisses, fixedMisses);
+}
+
+// Per-octant throughput of the specialized kernels against the generic
+// loop. Octants are numbered counter-clockwise from +x.
+void reportOctants(int W, int H) {
+    const int COUNT = 200000, MAX_LENGTH = 64;
+    Framebuffer generic(W, H), specialized(W, H);
+    printf("%d lines per octant (length <= %d)\n", COUNT, MAX_LENGTH);
+    printf("%-8s %16s %16s %8s\n", "octant", "generic Mpx/s", "octant Mpx/s", "match");
+    for (int octant = 0; octant < 8; octant++) {
+        // Major axis and step signs of each octant
+        bool xMajor = (octant % 4 == 0) || (octant % 4 == 3);
+        int sx = (octant < 2 || octant > 5) ? 1 : -1;
+        int sy = (octant < 4) ? 1 : -1;
+        mt19937 rng(octant + 100);
+        uniform_int_distribution<int> major(1, MAX_LENGTH), px(MAX_LENGTH, W - MAX_LENGTH - 1),
+            py(MAX_LENGTH, H - MAX_LENGTH - 1);
+        LineSet lines;
+        for (int i = 0; i < COUNT; i++) {
+            int a = major(rng), b = rng() % (a + 1);
+            int x0 = px(rng), y0 = py(rng);
+            lines.x0.push_back(x0);
+            lines.y0.push_back(y0);
+            lines.x1.push_back(x0 + sx * (xMajor ? a : b));
+            lines.y1.push_back(y0 + sy * (xMajor ? b : a));
+        }
+        long long pixels = countLinePixels(lines);
+        double genericTime = 1e30, octantTime = 1e30;
+        for (int run = 0; run < 3; run++) {
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < COUNT; i++) {
+                drawLineBresenham(lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i], generic);
+            }
+            genericTime = min(genericTime, secondsSince(start));
+            start = chrono::steady_clock::now();
+            for (int i = 0; i < COUNT; i++) {
+                drawLineBresenhamOctant(lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i], specialized);
+            }
+            octantTime = min(octantTime, secondsSince(start));
+        }
+        printf("%-8d %16.1f %16.1f %8s\n", octant, pixels / genericTime / 1e6,
+               pixels / octantTime / 1e6, generic.pixels == specialized.pixels ? "yes" : "NO");
+    }
+}
+
+// Renders a 100k-line scene with 1..N threads through the tiled renderer
+void reportTiledScaling(int W, int H) {
+    const int COUNT = 100000;
+    LineSet lines = makeRandomLines(COUNT, W, H, 64, 21);
+    Framebuffer serial(W, H), fb(W, H);
+    int maxThreads = max(1u, thread::hardware_concurrency());
+    printf("%d-line scene, 64x64 tiles, 1..%d threads\n", COUNT, maxThreads);
+    const char* names[] = {"DDA fixed", "Bresenham"};
+    for (LineAlgorithm algorithm : {LINE_DDA, LINE_BRESENHAM}) {
+        for (int i = 0; i < COUNT; i++) {
+            if (algorithm == LINE_BRESENHAM) {
+                drawLineBresenham(lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i], serial);
+            } else {
+                drawLineDDAFixed(lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i], serial);
+            }
+        }
+        double singleThread = 0;
+        for (int threads = 1; threads <= maxThreads; threads = (threads == maxThreads) ? threads + 1
+                                                                 : min(threads * 2, maxThreads)) {
+            ThreadPool pool(threads);
+            TiledLineRenderer renderer(64);
+            double best = 1e30;
+            for (int run = 0; run < 5; run++) {
+                fb.clear();
+                auto start = chrono::steady_clock::now();
+                renderer.render(lines, algorithm, fb, pool);
+                best = min(best, secondsSince(start));
+            }
+            if (threads == 1) singleThread = best;
+            printf("  %-10s %2d threads %8.2f ms %6.2fx  matches serial: %s\n", names[algorithm],
+                   threads, best * 1e3, singleThread / best, fb.pixels == serial.pixels ? "yes" : "NO");
+        }
+        serial.clear();
+    }
+}
+
+// Lines whose endpoints lie far outside the framebuffer: compares the
+// full walk (discarding off-screen pixels) with the pre-clipped walk
+void reportClippedLines(int W, int H) {
+    const int COUNT = 20000;
+    mt19937 rng(11);
+    uniform_int_distribution<int> far(-16 * W, 17 * W);
+    LineSet lines;
+    for (int i = 0; i < COUNT; i++) {
+        lines.x0.push_back(far(rng)); lines.y0.push_back(far(rng));
+        lines.x1.push_back(far(rng)); lines.y1.push_back(far(rng));
+    }
+    Framebuffer fb(W, H);
+    printf("%d lines with endpoints up to 16 screens away\n", COUNT);
+    benchLines("Bresenham", lines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineBresenham(x0, y0, x1, y1, f);
+    });
+    Framebuffer reference = fb;
+    benchLines("Bresenham pre-clipped", lines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineBresenhamClipped(x0, y0, x1, y1, f);
+    });
+    printf("  pre-clipped matches unclipped: %s\n", fb.pixels == reference.pixels ? "yes" : "NO");
+    benchLines("DDA fixed", lines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineDDAFixed(x0, y0, x1, y1, f);
+    });
+    reference = fb;
+    benchLines("DDA fixed pre-clipped", lines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineDDAFixedClipped(x0, y0, x1, y1, f.originX, f.originY,
+                                f.originX + f.width - 1, f.originY + f.height - 1, f);
+    });
+    printf("  pre-clipped matches unclipped: %s\n", fb.pixels == reference.pixels ? "yes" : "NO");
+
+    // Far beyond what the unclipped walk could finish
+    LastPixelSink last;
+    drawLineBresenhamClipped(-2000000000, -1999999990, 2000000000, 2000000000,
+                             WINDOW_XMIN, WINDOW_YMIN, WINDOW_XMAX, WINDOW_YMAX, last);
+    printf("  line across the int range: %lld pixels in the demo window, last (%d, %d)\n",
+           last.count, last.x, last.y);
+
+    // Clipped near the far end, where the entry index times the minor
+    // delta is past 2^63
+    LastPixelSink farEnd;
+    drawLineBresenhamClipped(INT_MIN, INT_MIN, INT_MAX, INT_MAX - 7,
+                             INT_MAX - 300, INT_MAX - 310, INT_MAX - 200, INT_MAX - 200, farEnd);
+    printf("  same line near its far end: %lld pixels, last (max - %d, max - %d), "
+           "expected (max - 200, max - 207)\n", farEnd.count, INT_MAX - farEnd.x, INT_MAX - farEnd.y);
+}
+
+int runBenchmark() {
+    const int W = 1024, H = 1024, COUNT = 1000000;
+    LineSet lines = makeRandomLines(COUNT, W, H, 16, 1);
+    Framebuffer fb(W, H);
+    printf("%d random lines (length <= 16) into a %dx%d framebuffer\n", COUNT, W, H);
+    benchLines("DDA", lines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineDDA(x0, y0, x1, y1, f);
+    });
+    Framebuffer floatDDA = fb;
+    benchLines("DDA fixed 16.16", lines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineDDAFixed(x0, y0, x1, y1, f);
+    });
+    Framebuffer fixedDDA = fb;
+    benchLines("DDA fixed 16.16 wide", lines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineDDAFixedWide(x0, y0, x1, y1, f);
+    });
+    printf("  wide matches scalar fixed DDA: %s\n", fb.pixels == fixedDDA.pixels ? "yes" : "NO");
+    size_t differing = 0;
+    for (size_t i = 0; i < fb.pixels.size(); i++) differing += fb.pixels[i] != floatDDA.pixels[i];
+    printf("  pixels differing from float DDA: %zu\n", differing);
+    reportDDAEndpoints();
+
+    // Long lines amortize the wide kernel's setup, but it still trails
+    // the scalar fixed DDA
+    LineSet longLines = makeRandomLines(COUNT / 10, W, H, 512, 3);
+    printf("%d random lines (length <= 512)\n", COUNT / 10);
+    benchLines("DDA", longLines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineDDA(x0, y0, x1, y1, f);
+    });
+    benchLines("DDA fixed 16.16", longLines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineDDAFixed(x0, y0, x1, y1, f);
+    });
+    benchLines("DDA fixed 16.16 wide", longLines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineDDAFixedWide(x0, y0, x1, y1, f);
+    });
+    reportClippedLines(W, H);
+    reportOctants(W, H);
+    reportTiledScaling(W, H);
+    printf("%d random lines (length <= 16)\n", COUNT);
+    benchLines("Bresenham", lines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineBresenham(x0, y0, x1, y1, f);
+    });
+    Framebuffer reference = fb;
+
+    double best = 1e30;
+    for (int run = 0; run < 3; run++) {
+        fb.clear();
+        auto start = chrono::steady_clock::now();
+        drawLinesBresenhamBatch(lines.x0.data(), lines.y0.data(), lines.x1.data(), lines.y1.data(),
+                                COUNT, fb);
+        best = min(best, secondsSince(start));
+    }
+#if defined(__AVX2__)
+    reportThroughput("Bresenham batch (AVX2 x8)", COUNT, countLinePixels(lines), best);
+#elif defined(__SSE2__)
+    reportThroughput("Bresenham batch (SSE2 x4)", COUNT, countLinePixels(lines), best);
+#else
+    reportThroughput("Bresenham batch (scalar)", COUNT, countLinePixels(lines), best);
+#endif
+    printf("  batch matches scalar Bresenham: %s\n", fb.pixels == reference.pixels ? "yes" : "NO");
+    benchLines("Bresenham run slice", lines, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineRunSlice(x0, y0, x1, y1, f);
+    });
+    printf("  run slice matches scalar Bresenham: %s\n", fb.pixels == reference.pixels ? "yes" : "NO");
+
+    // Shallow lines are where runs get long
+    LineSet shallow = makeRandomLines(COUNT / 10, W, H, 512, 9);
+    for (size_t i = 0; i < shallow.y1.size(); i++) {
+        shallow.y1[i] = min(max(shallow.y0[i] + (shallow.y1[i] - shallow.y0[i]) / 16, 0), H - 1);
+    }
+    printf("%d shallow lines (|slope| <= 1/16, length <= 512)\n", COUNT / 10);
+    benchLines("Bresenham", shallow, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineBresenham(x0, y0, x1, y1, f);
+    });
+    reference = fb;
+    benchLines("Bresenham run slice", shallow, fb, [](int x0, int y0, int x1, int y1, Framebuffer& f) {
+        drawLineRunSlice(x0, y0, x1, y1, f);
+    });
+    printf("  run slice matches scalar Bresenham: %s\n", fb.pixels == reference.pixels ? "yes" : "NO");
+    return 0;
+}
+
+// Renders both demo lines over the gluOrtho2D(-10, 10, -5, 15) window,
+// one framebuffer pixel per world unit
+int writeDemoImage(const char* path) {
+    Framebuffer fb(21, 21, -10, -5);
+    fb.clear(0xFFFFFF);
+    fb.setColor(1.0f, 0.0f, 0.0f); // Red for DDA
+    drawLineDDA(x_start, y_start, x_end, y_end, fb);
+    fb.setColor(0.0f, 0.0f, 1.0f); // Blue for Bresenham
+    drawLineBresenham(x_start, y_start, x_end, y_end, fb);
+    if (!fb.writePPM(path)) {
+        cerr << "Could not write " << path << endl;
+        return 1;
+    }
+    cout << "Wrote " << path << endl;
+    return 0;
+}
+
 int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) return runBenchmark();
+    if (argc > 2 && strcmp(argv[1], "--ppm") == 0) return writeDemoImage(argv[2]);
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(500, 500);
@@ -91,14 +944,14 @@ int main(int argc, char** argv) {
     int win1 = glutCreateWindow("DDA Line Algorithm");
     glClearColor(1.0, 1.0, 1.0, 1.0);
     glMatrixMode(GL_PROJECTION);
-    gluOrtho2D(-10.0, 10.0, -5.0, 15.0);
+    gluOrtho2D(WINDOW_XMIN, WINDOW_XMAX, WINDOW_YMIN, WINDOW_YMAX);
     glutDisplayFunc(displayDDA);
 
     glutInitWindowPosition(700, 100);
     int win2 = glutCreateWindow("Bresenham's Line Algorithm");
     glClearColor(1.0, 1.0, 1.0, 1.0);
     glMatrixMode(GL_PROJECTION);
-    gluOrtho2D(-10.0, 10.0, -5.0, 15.0);
+    gluOrtho2D(WINDOW_XMIN, WINDOW_XMAX, WINDOW_YMIN, WINDOW_YMAX);
     glutDisplayFunc(displayBresenham);
 
     glutMainLoop();
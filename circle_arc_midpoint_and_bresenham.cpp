@@ -1,20 +1,268 @@
 #include <GL/glut.h>
 #include <cmath>
 #include <iostream>
+#include <cstring>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "framebuffer.h"
+#include "thread_pool.h"
+#include "vertex_batch.h"
 
 // Window dimensions
 const int WINDOW_WIDTH = 800;
 const int WINDOW_HEIGHT = 600;
 
+// Every pixel of a frame goes through one batch; display() flushes it
+// whenever the color or point size changes
+VertexBatch pointBatch(GL_POINTS);
+
 // Draw a pixel
 void drawPixel(int x, int y) {
-    glBegin(GL_POINTS);
-    glVertex2i(x, y);
-    glEnd();
+    pointBatch.add(x, y);
 }
 
-// Draw arc using midpoint circle algorithm
-void drawCircleArc(int cx, int cy, int r, double sa, double ea) {
+// Counts last printed for one window. Both windows share pointBatch, so
+// its own frame-to-frame comparison would see them alternate.
+struct WindowFrameCounts {
+    size_t pixels = 0;
+    size_t drawCalls = 0;
+};
+
+WindowFrameCounts arcWindowCounts, circleWindowCounts;
+
+// Submits the frame's pixels and prints the counts when they change from
+// this window's previous frame
+void finishFrame(const char* window, WindowFrameCounts& last) {
+    pointBatch.endFrame();
+    if (pointBatch.frameVertices != last.pixels || pointBatch.frameDrawCalls != last.drawCalls) {
+        last.pixels = pointBatch.frameVertices;
+        last.drawCalls = pointBatch.frameDrawCalls;
+        std::cout << window << ": " << last.pixels << " pixels, "
+                  << last.drawCalls << " draw calls per frame\n";
+    }
+}
+
+// Pixel sink that feeds drawPixel. Framebuffer (framebuffer.h) offers the
+// same plot(x, y) for headless rendering.
+struct PointBatchSink {
+    void plot(int x, int y) { drawPixel(x, y); }
+};
+
+// ---------------------------------------------------------------------
+// Per-radius offset cache. A rasterized circle is fully described by its
+// first octant: ys[x] is the y of the point in column x, for every
+// x <= y. Instances at any center are stamped from that list through
+// 8-way symmetry, so the decision loop runs once per radius instead of
+// once per circle. Entries are evicted least recently used first once
+// the byte budget is exceeded. Lookups reorder the LRU list, so the cache
+// is single-threaded: parallel code resolves its offsets up front (see
+// BulkCircleRenderer).
+// ---------------------------------------------------------------------
+
+typedef std::vector<int> OctantOffsets;
+
+enum CircleKernel { MIDPOINT_CIRCLE, BRESENHAM_CIRCLE };
+
+// Runs the decision loop of the given algorithm once. A negative radius
+// has no points.
+OctantOffsets computeOctantOffsets(CircleKernel kernel, int r) {
+    OctantOffsets ys;
+    if (r < 0) return ys;
+    ys.reserve(r * 3 / 4 + 2);
+    int x = 0, y = r;
+    if (kernel == MIDPOINT_CIRCLE) {
+        int p = 1 - r;
+        while (x <= y) {
+            ys.push_back(y);
+            x++;
+            if (p < 0) p += 2 * x + 1;
+            else { y--; p += 2 * (x - y) + 1; }
+        }
+    } else {
+        int d = 3 - 2 * r;
+        while (x <= y) {
+            ys.push_back(y);
+            if (d < 0) {
+                d = d + 4 * x + 6;
+            } else {
+                d = d + 4 * (x - y) + 10;
+                y--;
+            }
+            x++;
+        }
+    }
+    return ys;
+}
+
+class CircleOffsetCache {
+public:
+    explicit CircleOffsetCache(size_t capacityBytes) : capacity(capacityBytes) {}
+
+    // Cached offsets, or null without computing anything on a miss. Every
+    // lookup counts as a hit or a miss, whoever handles the miss.
+    std::shared_ptr<const OctantOffsets> find(CircleKernel kernel, int r) {
+        auto found = index.find((long long)r * 2 + kernel);
+        if (found == index.end()) {
+            misses++;
+            return nullptr;
+        }
+        hits++;
+        lru.splice(lru.begin(), lru, found->second);
+        return found->second->offsets;
+    }
+
+    // Offsets stay valid for as long as the caller holds the pointer,
+    // even if the entry is evicted meanwhile. Negative radii get an empty
+    // list and are never cached.
+    std::shared_ptr<const OctantOffsets> get(CircleKernel kernel, int r) {
+        if (r < 0) return std::make_shared<const OctantOffsets>();
+        std::shared_ptr<const OctantOffsets> cached = find(kernel, r);
+        if (cached) return cached;
+        long long key = (long long)r * 2 + kernel;
+        auto offsets = std::make_shared<const OctantOffsets>(computeOctantOffsets(kernel, r));
+        size_t size = entryBytes(*offsets);
+        if (size > capacity) return offsets; // would never fit; not cached
+        lru.push_front(Entry{key, offsets, size});
+        index[key] = lru.begin();
+        used += size;
+        evictTo(capacity);
+        return offsets;
+    }
+
+    void setCapacity(size_t bytes) {
+        capacity = bytes;
+        evictTo(capacity);
+    }
+
+    size_t bytes() const { return used; }
+    size_t entries() const { return lru.size(); }
+
+    size_t hits = 0, misses = 0, evictions = 0;
+
+private:
+    struct Entry {
+        long long key;
+        std::shared_ptr<const OctantOffsets> offsets;
+        size_t bytes;
+    };
+    std::list<Entry> lru; // most recently used first
+    std::unordered_map<long long, std::list<Entry>::iterator> index;
+    size_t capacity;
+    size_t used = 0;
+
+    // Offset storage plus a rough per-entry bookkeeping cost
+    static size_t entryBytes(const OctantOffsets& ys) {
+        return ys.capacity() * sizeof(int) + sizeof(Entry) + 64;
+    }
+
+    void evictTo(size_t limit) {
+        while (used > limit && !lru.empty()) {
+            used -= lru.back().bytes;
+            index.erase(lru.back().key);
+            lru.pop_back();
+            evictions++;
+        }
+    }
+};
+
+CircleOffsetCache circleCache(1 << 20);
+
+// y of the midpoint circle's first-octant point in column x, without
+// walking columns 0 .. x - 1. The decision loop keeps y while the
+// midpoint (x, y - 1/2) is inside, which makes y the largest integer with
+// y * (y - 1) < r^2 - x^2.
+int midpointColumnY(int r, int x) {
+    long long rhs = (long long)r * r - (long long)x * x;
+    long long y = (long long)((1 + sqrt(1.0 + 4.0 * rhs)) / 2);
+    while (y > 0 && y * (y - 1) >= rhs) y--;
+    while ((y + 1) * y < rhs) y++;
+    return (int)y;
+}
+
+// Columns of the midpoint circle without a cached octant. The column after
+// the last one asked for is one decision step away; any other column is
+// found through midpointColumnY.
+struct MidpointColumns {
+    int r;
+    int x = -2, y = 0;
+
+    int operator()(int column) {
+        if (column == x + 1) {
+            long long rhs = (long long)r * r - (long long)column * column;
+            if ((long long)y * (y - 1) >= rhs) y--;
+        } else if (column != x) {
+            y = midpointColumnY(r, column);
+        }
+        x = column;
+        return y;
+    }
+};
+
+// Last column of the midpoint circle's first octant (the last x <= y)
+int midpointLastColumn(int r) {
+    int x = (int)(r / sqrt(2.0));
+    while (x + 1 <= midpointColumnY(r, x + 1)) x++;
+    while (x > 0 && x > midpointColumnY(r, x)) x--;
+    return x;
+}
+
+// The eight images of a first-octant point (x, y), indexed by the 45 degree
+// sector they land in, counter-clockwise from +x. In even sectors the
+// angle grows with x, in odd sectors it shrinks.
+struct OctantImage {
+    bool swap;
+    int sx, sy;
+};
+const OctantImage OCTANT_IMAGES[8] = {
+    {true, 1, 1}, {false, 1, 1}, {false, -1, 1}, {true, -1, 1},
+    {true, -1, -1}, {false, -1, -1}, {false, 1, -1}, {true, 1, -1},
+};
+
+// Scale of the integer boundary directions used by the arc range test
+const double ARC_BOUNDARY_SCALE = 1 << 20;
+
+// Draws the first-octant points whose angle phi = atan(x / y) lies in
+// [phiStart, phiEnd] as their image in sector k. ys(x) gives the y of
+// column x for x = 0 .. last. The range test compares each point against
+// two integer boundary directions with cross products. The walk starts at
+// the first point inside the range and stops at the first point past it.
+template <typename Column, typename Sink>
+void drawOctantArc(int cx, int cy, Column ys, int last, int k,
+                   double phiStart, double phiEnd, Sink& sink) {
+    long long ax = llround(ARC_BOUNDARY_SCALE * sin(phiStart));
+    long long ay = llround(ARC_BOUNDARY_SCALE * cos(phiStart));
+    long long bx = llround(ARC_BOUNDARY_SCALE * sin(phiEnd));
+    long long by = llround(ARC_BOUNDARY_SCALE * cos(phiEnd));
+    auto afterStart = [&](int x) { return x * ay - ys(x) * ax >= 0; };
+    auto beforeEnd = [&](int x) { return x * by - ys(x) * bx <= 0; };
+
+    // Seed x from the start angle, then settle it on the first point in range
+    int x = std::min((int)(ys(0) * sin(phiStart)), last);
+    while (x > 0 && afterStart(x - 1)) x--;
+    while (x <= last && !afterStart(x)) x++;
+
+    const OctantImage& image = OCTANT_IMAGES[k];
+    for (; x <= last && beforeEnd(x); x++) {
+        int y = ys(x);
+        if (image.swap) sink.plot(cx + image.sx * y, cy + image.sy * x);
+        else sink.plot(cx + image.sx * x, cy + image.sy * y);
+    }
+}
+
+// Draw arc using midpoint circle algorithm. The angle range is split into
+// its 45 degree sectors once, and only the covered part of each sector
+// is walked, so the cost follows the arc length instead of the
+// circumference. Cached offsets are used when the radius is already in
+// circleCache; otherwise each column's y is computed directly rather
+// than filling the cache with the whole octant.
+template <typename Sink>
+void drawCircleArc(int cx, int cy, int r, double sa, double ea, Sink& sink) {
+    if (r < 0) return;
     // Normalize angles to [0, 2pi)
     while (sa < 0) sa += 2 * M_PI;
     while (ea < 0) ea += 2 * M_PI;
@@ -22,46 +270,173 @@ void drawCircleArc(int cx, int cy, int r, double sa, double ea) {
     ea = fmod(ea, 2 * M_PI);
     if (ea < sa) ea += 2 * M_PI;
 
-    auto plot = [&](int x, int y) {
-        double angle = atan2(y, x);
-        if (angle < 0) angle += 2 * M_PI;
-        double a = angle;
-        while (a < sa) a += 2 * M_PI;
-        while (a > ea) a -= 2 * M_PI;
-        if (a >= sa && a <= ea) drawPixel(cx + x, cy + y);
+    std::shared_ptr<const OctantOffsets> cached = circleCache.find(MIDPOINT_CIRCLE, r);
+    auto fromCache = [&](int x) { return (*cached)[x]; };
+    MidpointColumns direct{r};
+    int last = cached ? (int)cached->size() - 1 : midpointLastColumn(r);
+    auto sector = [&](int k, double phiStart, double phiEnd) {
+        if (cached) drawOctantArc(cx, cy, fromCache, last, k, phiStart, phiEnd, sink);
+        else drawOctantArc(cx, cy, direct, last, k, phiStart, phiEnd, sink);
     };
 
-    int x = 0, y = r, p = 1 - r;
-    while (x <= y) {
-        plot(x, y); plot(y, x); plot(-x, y); plot(-y, x);
-        plot(-x, -y); plot(-y, -x); plot(x, -y); plot(y, -x);
-        x++;
-        if (p < 0) p += 2 * x + 1;
-        else { y--; p += 2 * (x - y) + 1; }
+    // An arc that wraps past 2pi is two pieces within [0, 2pi]
+    double pieces[2][2] = {{sa, std::min(ea, 2 * M_PI)}, {0, ea - 2 * M_PI}};
+    int pieceCount = ea > 2 * M_PI ? 2 : 1;
+    for (int i = 0; i < pieceCount; i++) {
+        for (int k = 0; k < 8; k++) {
+            double lo = std::max(pieces[i][0], k * M_PI / 4);
+            double hi = std::min(pieces[i][1], (k + 1) * M_PI / 4);
+            if (lo > hi) continue;
+            if (k % 2 == 0) sector(k, lo - k * M_PI / 4, hi - k * M_PI / 4);
+            else sector(k, (k + 1) * M_PI / 4 - hi, (k + 1) * M_PI / 4 - lo);
+        }
+    }
+}
+
+void drawCircleArc(int cx, int cy, int r, double sa, double ea) {
+    PointBatchSink sink;
+    drawCircleArc(cx, cy, r, sa, ea, sink);
+}
+
+// Stamps a cached first-octant offset list at (cx, cy)
+template <typename Sink>
+void stampCircle(int cx, int cy, const OctantOffsets& ys, Sink& sink) {
+    for (int x = 0; x < (int)ys.size(); x++) {
+        int y = ys[x];
+        sink.plot(cx + x, cy + y);
+        sink.plot(cx - x, cy + y);
+        sink.plot(cx + x, cy - y);
+        sink.plot(cx - x, cy - y);
+        sink.plot(cx + y, cy + x);
+        sink.plot(cx - y, cy + x);
+        sink.plot(cx + y, cy - x);
+        sink.plot(cx - y, cy - x);
     }
 }
 
 // Draw a full circle using Bresenham's algorithm
+template <typename Sink>
+void drawBresenhamCircle(int cx, int cy, int r, Sink& sink) {
+    if (r < 0) return;
+    stampCircle(cx, cy, *circleCache.get(BRESENHAM_CIRCLE, r), sink);
+}
+
 void drawBresenhamCircle(int cx, int cy, int r) {
-    int x = 0, y = r;
-    int d = 3 - 2 * r;
-    while (x <= y) {
-        drawPixel(cx + x, cy + y);
-        drawPixel(cx - x, cy + y);
-        drawPixel(cx + x, cy - y);
-        drawPixel(cx - x, cy - y);
-        drawPixel(cx + y, cy + x);
-        drawPixel(cx - y, cy + x);
-        drawPixel(cx + y, cy - x);
-        drawPixel(cx - y, cy - x);
-        if (d < 0) {
-            d = d + 4 * x + 6;
+    PointBatchSink sink;
+    drawBresenhamCircle(cx, cy, r, sink);
+}
+
+// ---------------------------------------------------------------------
+// Midpoint ellipse. Region 1 steps x while the slope is shallower than
+// -1, region 2 steps y after that. All decision terms are scaled by 4 to
+// stay integral. Each first-quadrant point is mirrored into the other
+// three quadrants.
+// ---------------------------------------------------------------------
+
+// Calls emit(x, y) for every first-quadrant point, from (0, ry) to (rx, 0).
+// On thin ellipses region 2 reaches y = 0 before x reaches rx; the rest
+// of the tip is the run along the major axis.
+template <typename Emit>
+void walkEllipseQuadrant(int rx, int ry, Emit emit) {
+    long long rx2 = (long long)rx * rx, ry2 = (long long)ry * ry;
+    if (ry == 0) {
+        for (int x = 0; x <= rx; x++) emit(x, 0);
+        return;
+    }
+    long long x = 0, y = ry;
+    long long d1 = 4 * ry2 - 4 * rx2 * ry + rx2;
+    while (ry2 * x < rx2 * y) {
+        emit((int)x, (int)y);
+        if (d1 < 0) {
+            d1 += 4 * ry2 * (2 * x + 3);
         } else {
-            d = d + 4 * (x - y) + 10;
+            d1 += 4 * ry2 * (2 * x + 3) + 4 * rx2 * (2 - 2 * y);
             y--;
         }
         x++;
     }
+    long long d2 = ry2 * (2 * x + 1) * (2 * x + 1) + 4 * rx2 * (y - 1) * (y - 1) - 4 * rx2 * ry2;
+    while (y > 0) {
+        emit((int)x, (int)y);
+        if (d2 > 0) {
+            d2 += 4 * rx2 * (3 - 2 * y);
+        } else {
+            d2 += 4 * ry2 * (2 * x + 2) + 4 * rx2 * (3 - 2 * y);
+            x++;
+        }
+        y--;
+    }
+    for (; x <= rx; x++) emit((int)x, 0);
+}
+
+template <typename Sink>
+void drawEllipse(int cx, int cy, int rx, int ry, Sink& sink) {
+    walkEllipseQuadrant(rx, ry, [&](int x, int y) {
+        sink.plot(cx + x, cy + y);
+        sink.plot(cx - x, cy + y);
+        sink.plot(cx - x, cy - y);
+        sink.plot(cx + x, cy - y);
+    });
+}
+
+void drawEllipse(int cx, int cy, int rx, int ry) {
+    PointBatchSink sink;
+    drawEllipse(cx, cy, rx, ry, sink);
+}
+
+// Elliptical arc with the drawCircleArc interface. Angles are polar
+// angles of the pixels around the center. The angle range is split into
+// quadrants once. In each covered quadrant a first-quadrant point is kept
+// when it lies between two integer boundary directions, tested with cross
+// products, so no trig runs per pixel.
+template <typename Sink>
+void drawEllipseArc(int cx, int cy, int rx, int ry, double sa, double ea, Sink& sink) {
+    // Normalize angles to [0, 2pi)
+    while (sa < 0) sa += 2 * M_PI;
+    while (ea < 0) ea += 2 * M_PI;
+    sa = fmod(sa, 2 * M_PI);
+    ea = fmod(ea, 2 * M_PI);
+    if (ea < sa) ea += 2 * M_PI;
+
+    // Per covered quadrant range: mirror signs and the two boundaries
+    // expressed in first-quadrant coordinates
+    struct QuadrantRange {
+        int sx, sy;
+        long long ax, ay, bx, by;
+    };
+    const int QUADRANT_SIGNS[4][2] = {{1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+    QuadrantRange ranges[8];
+    int rangeCount = 0;
+    double pieces[2][2] = {{sa, std::min(ea, 2 * M_PI)}, {0, ea - 2 * M_PI}};
+    int pieceCount = ea > 2 * M_PI ? 2 : 1;
+    for (int i = 0; i < pieceCount; i++) {
+        for (int q = 0; q < 4; q++) {
+            double lo = std::max(pieces[i][0], q * M_PI / 2);
+            double hi = std::min(pieces[i][1], (q + 1) * M_PI / 2);
+            if (lo > hi) continue;
+            // Quadrants 1 and 3 run backwards when mirrored into quadrant 0
+            double a = (q % 2 == 0) ? lo - q * M_PI / 2 : (q + 1) * M_PI / 2 - hi;
+            double b = (q % 2 == 0) ? hi - q * M_PI / 2 : (q + 1) * M_PI / 2 - lo;
+            ranges[rangeCount++] = QuadrantRange{
+                QUADRANT_SIGNS[q][0], QUADRANT_SIGNS[q][1],
+                llround(ARC_BOUNDARY_SCALE * cos(a)), llround(ARC_BOUNDARY_SCALE * sin(a)),
+                llround(ARC_BOUNDARY_SCALE * cos(b)), llround(ARC_BOUNDARY_SCALE * sin(b))};
+        }
+    }
+
+    walkEllipseQuadrant(rx, ry, [&](int x, int y) {
+        for (int i = 0; i < rangeCount; i++) {
+            const QuadrantRange& range = ranges[i];
+            if (range.ax * y - range.ay * x >= 0 && range.bx * y - range.by * x <= 0) {
+                sink.plot(cx + range.sx * x, cy + range.sy * y);
+            }
+        }
+    });
+}
+
+void drawEllipseArc(int cx, int cy, int rx, int ry, double sa, double ea) {
+    PointBatchSink sink;
+    drawEllipseArc(cx, cy, rx, ry, sa, ea, sink);
 }
 
 void display() {
@@ -89,15 +464,23 @@ void display() {
     glColor3f(0, 1, 0);
     glPointSize(8.0f);
     drawPixel(centerX, centerY);
+    pointBatch.flush();
     glPointSize(4.0f); // Restore point size
 
     // Draw arc (white)
     glColor3f(1, 1, 1);
     drawCircleArc(centerX, centerY, radius, startAngle, endAngle);
+    pointBatch.flush();
 
     // Draw full circle (blue, Bresenham)
     glColor3f(0, 0.5, 1);
     drawBresenhamCircle(centerX, centerY, radius);
+    pointBatch.flush();
+
+    // Draw elliptical arc (yellow, midpoint ellipse)
+    glColor3f(1, 1, 0);
+    drawEllipseArc(centerX, centerY, radius + 60, radius / 2, 7 * M_PI / 6, 11 * M_PI / 6);
+    finishFrame("Static Circle Arc", arcWindowCounts);
 
     glutSwapBuffers();
     glFlush();
@@ -111,6 +494,7 @@ void displayBresenhamOnly() {
     // Draw full circle (blue, Bresenham)
     glColor3f(0, 0.5, 1);
     drawBresenhamCircle(centerX, centerY, radius);
+    finishFrame("Bresenham Circle Only", circleWindowCounts);
     glutSwapBuffers();
     glFlush();
 }
@@ -132,7 +516,485 @@ void init() {
     glPointSize(4.0f);
 }
 
+// ---------------------------------------------------------------------
+// Filled shapes. The cached midpoint octant gives the outline's half
+// width on every row, and each row is filled with one Framebuffer::hspan
+// (vector stores) instead of point by point.
+// ---------------------------------------------------------------------
+
+// hw[v] = largest |u| of an outline pixel on row v, for v = 0 .. r
+void circleHalfWidths(const OctantOffsets& ys, int r, std::vector<int>& hw) {
+    hw.assign(r + 1, 0);
+    for (int x = 0; x < (int)ys.size(); x++) {
+        hw[ys[x]] = std::max(hw[ys[x]], x);
+        hw[x] = std::max(hw[x], ys[x]);
+    }
+}
+
+// Disc of radius r: every pixel on or inside the midpoint circle. Reuses
+// static scratch and circleCache, so call it from one thread only.
+void fillDisc(int cx, int cy, int r, Framebuffer& fb) {
+    if (r < 0) return;
+    static std::vector<int> hw;
+    circleHalfWidths(*circleCache.get(MIDPOINT_CIRCLE, r), r, hw);
+    fb.hspan(cy, cx - hw[0], cx + hw[0]);
+    for (int v = 1; v <= r; v++) {
+        fb.hspan(cy + v, cx - hw[v], cx + hw[v]);
+        fb.hspan(cy - v, cx - hw[v], cx + hw[v]);
+    }
+}
+
+// hole[v] = smallest |u| of an outline pixel on row v, for v = 0 .. r.
+// Near the top, a row holds a whole run of outline pixels, so this
+// differs from the half width there.
+void circleHoleWidths(const OctantOffsets& ys, int r, std::vector<int>& hole) {
+    hole.assign(r + 1, r);
+    for (int x = 0; x < (int)ys.size(); x++) {
+        hole[ys[x]] = std::min(hole[ys[x]], x);
+        hole[x] = std::min(hole[x], ys[x]);
+    }
+}
+
+// Ring between two midpoint circles, both outlines included. Rows that
+// cross the hole get two spans, the rest one. Single-threaded, like
+// fillDisc.
+void fillAnnulus(int cx, int cy, int innerR, int outerR, Framebuffer& fb) {
+    if (innerR > outerR) std::swap(innerR, outerR);
+    if (innerR < 0) return;
+    static std::vector<int> outer, hole;
+    circleHalfWidths(*circleCache.get(MIDPOINT_CIRCLE, outerR), outerR, outer);
+    circleHoleWidths(*circleCache.get(MIDPOINT_CIRCLE, innerR), innerR, hole);
+    auto row = [&](int v, int y) {
+        if (v <= innerR && hole[v] > 0) {
+            fb.hspan(y, cx - outer[v], cx - hole[v]);
+            fb.hspan(y, cx + hole[v], cx + outer[v]);
+        } else {
+            fb.hspan(y, cx - outer[v], cx + outer[v]);
+        }
+    };
+    row(0, cy);
+    for (int v = 1; v <= outerR; v++) {
+        row(v, cy + v);
+        row(v, cy - v);
+    }
+}
+
+// ---------------------------------------------------------------------
+// Bulk circle rendering for particle-style scenes. The screen is cut into
+// horizontal bands, and each band is rendered by one pool thread into
+// that thread's own band buffer, then merged back. Offsets for every
+// distinct radius are resolved up front, so the hot path only reads
+// shared data and never takes a lock.
+// ---------------------------------------------------------------------
+
+struct CircleInstance {
+    int cx, cy, r;
+};
+
+// stampCircle limited to rows [rowMin, rowMax]. Only the columns of the
+// octant that land in those rows are visited. ys is non-increasing, so
+// rows cy +- ys[x] map to a contiguous range of x.
+template <typename Sink>
+void stampCircleRows(int cx, int cy, const OctantOffsets& ys, int rowMin, int rowMax, Sink& sink) {
+    int last = (int)ys.size() - 1;
+    for (int x = std::max(0, rowMin - cy); x <= std::min(last, rowMax - cy); x++) {
+        sink.plot(cx + ys[x], cy + x);
+        sink.plot(cx - ys[x], cy + x);
+    }
+    for (int x = std::max(0, cy - rowMax); x <= std::min(last, cy - rowMin); x++) {
+        sink.plot(cx + ys[x], cy - x);
+        sink.plot(cx - ys[x], cy - x);
+    }
+    auto columns = [&](int lo, int hi, int sign) {
+        auto first = std::lower_bound(ys.begin(), ys.end(), hi, std::greater<int>());
+        auto end = std::upper_bound(ys.begin(), ys.end(), lo, std::greater<int>());
+        for (auto it = first; it < end; ++it) {
+            int x = (int)(it - ys.begin());
+            sink.plot(cx + x, cy + sign * *it);
+            sink.plot(cx - x, cy + sign * *it);
+        }
+    };
+    columns(rowMin - cy, rowMax - cy, 1);
+    columns(cy - rowMax, cy - rowMin, -1);
+}
+
+struct BulkCircleRenderer {
+    int bandHeight;
+    std::vector<std::vector<int>> bands;     // circle indices per band
+    std::vector<Framebuffer> workerBuffers;  // one band buffer per pool thread
+    std::unordered_map<int, std::shared_ptr<const OctantOffsets>> offsets;
+
+    explicit BulkCircleRenderer(int height) : bandHeight(height) {}
+
+    void render(const CircleInstance* circles, int count, Framebuffer& fb, ThreadPool& pool) {
+        offsets.clear();
+        int bandCount = (fb.height + bandHeight - 1) / bandHeight;
+        bands.resize(bandCount);
+        for (auto& band : bands) band.clear();
+        for (int i = 0; i < count; i++) {
+            const CircleInstance& c = circles[i];
+            if (!offsets.count(c.r)) offsets[c.r] = circleCache.get(BRESENHAM_CIRCLE, c.r);
+            int top = c.cy + c.r - fb.originY, bottom = c.cy - c.r - fb.originY;
+            if (top < 0 || bottom >= fb.height) continue;
+            int b0 = std::max(bottom, 0) / bandHeight;
+            int b1 = std::min(top, fb.height - 1) / bandHeight;
+            for (int b = b0; b <= b1; b++) bands[b].push_back(i);
+        }
+        if (!workerBuffers.empty() && workerBuffers[0].width != fb.width) workerBuffers.clear();
+        while ((int)workerBuffers.size() < pool.size()) workerBuffers.emplace_back(fb.width, bandHeight);
+
+        pool.parallelFor(bandCount, [&](int band, int worker) {
+            Framebuffer& buffer = workerBuffers[worker];
+            int rows = std::min(bandHeight, fb.height - band * bandHeight);
+            size_t first = (size_t)band * bandHeight * fb.width;
+            size_t pixels = (size_t)rows * fb.width;
+            buffer.originX = fb.originX;
+            buffer.originY = fb.originY + band * bandHeight;
+            buffer.height = rows;
+            buffer.color = fb.color;
+            std::copy_n(&fb.pixels[first], pixels, buffer.pixels.begin());
+            int rowMin = buffer.originY, rowMax = buffer.originY + rows - 1;
+            for (int i : bands[band]) {
+                const CircleInstance& c = circles[i];
+                stampCircleRows(c.cx, c.cy, *offsets.at(c.r), rowMin, rowMax, buffer);
+            }
+            std::copy_n(buffer.pixels.begin(), pixels, &fb.pixels[first]);
+        });
+    }
+};
+
+// ---------------------------------------------------------------------
+// Headless mode: ./output --bench rasterizes into a Framebuffer without
+// a GL context.
+// ---------------------------------------------------------------------
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Circle instances with a few repeated radii
+struct CircleScene {
+    std::vector<int> cx, cy, r;
+};
+
+CircleScene makeRandomCircles(int count, int width, int height, const std::vector<int>& radii,
+                              unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> px(0, width - 1), py(0, height - 1);
+    std::uniform_int_distribution<int> pick(0, (int)radii.size() - 1);
+    CircleScene scene;
+    for (int i = 0; i < count; i++) {
+        scene.cx.push_back(px(rng));
+        scene.cy.push_back(py(rng));
+        scene.r.push_back(radii[pick(rng)]);
+    }
+    return scene;
+}
+
+// Draws the scene through drawBresenhamCircle with the cache limited to
+// capacityBytes and reports time and cache counters
+void benchCircleCache(const char* name, const CircleScene& scene, size_t capacityBytes,
+                      Framebuffer& fb) {
+    circleCache = CircleOffsetCache(capacityBytes);
+    fb.clear();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < scene.r.size(); i++) {
+        drawBresenhamCircle(scene.cx[i], scene.cy[i], scene.r[i], fb);
+    }
+    double seconds = secondsSince(start);
+    printf("%-22s %8.2f ms  hits %7zu  misses %7zu  evictions %7zu  %7zu bytes cached\n",
+           name, seconds * 1e3, circleCache.hits, circleCache.misses, circleCache.evictions,
+           circleCache.bytes());
+}
+
+// Collects plotted pixels for comparisons
+struct PixelSetSink {
+    std::set<std::pair<int, int>> pixels;
+    void plot(int x, int y) { pixels.insert(std::make_pair(x, y)); }
+};
+
+// Polar angle of (x, y) in [0, 2pi)
+double polarAngle(int x, int y) {
+    double angle = atan2((double)y, (double)x);
+    return angle < 0 ? angle + 2 * M_PI : angle;
+}
+
+// Ellipse outline and arc checks, thin shapes included. Returns the
+// number of failed checks.
+int checkEllipses() {
+    const int SHAPES[][2] = {{396, 1}, {100, 1}, {100, 7}, {1, 100}, {200, 3}, {260, 100}, {50, 50}, {7, 2}};
+    const double ARCS[][2] = {{0, M_PI / 3}, {-M_PI / 6, M_PI / 12}, {7 * M_PI / 6, 11 * M_PI / 6},
+                              {M_PI / 2, 3 * M_PI / 2}, {5.5, 0.4}};
+    int failures = 0;
+    size_t arcPixels = 0;
+    for (const auto& shape : SHAPES) {
+        int rx = shape[0], ry = shape[1];
+        // Quadrant walk: from (0, ry) to (rx, 0), 8-connected and monotone
+        int lastX = -1, lastY = -1, firstX = -1, firstY = -1, breaks = 0;
+        walkEllipseQuadrant(rx, ry, [&](int x, int y) {
+            if (firstX < 0) {
+                firstX = x;
+                firstY = y;
+            } else if (x < lastX || y > lastY || x - lastX > 1 || lastY - y > 1) {
+                breaks++;
+            }
+            lastX = x;
+            lastY = y;
+        });
+        bool walkOk = firstX == 0 && firstY == ry && lastX == rx && lastY == 0 && breaks == 0;
+
+        // A full-range arc is the whole ellipse, and arcs reach the tips
+        PixelSetSink full, whole, tips;
+        drawEllipse(0, 0, rx, ry, full);
+        drawEllipseArc(0, 0, rx, ry, 0, 2 * M_PI - 1e-12, whole);
+        drawEllipseArc(0, 0, rx, ry, -0.01, 0.01, tips);
+        drawEllipseArc(0, 0, rx, ry, M_PI - 0.01, M_PI + 0.01, tips);
+        bool tipsOk = tips.pixels.count(std::make_pair(rx, 0)) && tips.pixels.count(std::make_pair(-rx, 0));
+
+        // Arcs keep exactly the outline pixels whose polar angle is in
+        // range; pixels within 1e-6 rad of a boundary may go either way
+        int arcMismatches = 0;
+        for (const auto& arc : ARCS) {
+            PixelSetSink sink;
+            drawEllipseArc(0, 0, rx, ry, arc[0], arc[1], sink);
+            arcPixels += sink.pixels.size();
+            double sa = fmod(arc[0] + 2 * M_PI, 2 * M_PI), ea = fmod(arc[1] + 2 * M_PI, 2 * M_PI);
+            for (const auto& p : full.pixels) {
+                double angle = polarAngle(p.first, p.second);
+                bool inside = sa <= ea ? (angle >= sa && angle <= ea) : (angle >= sa || angle <= ea);
+                double margin = std::min(std::min(fabs(angle - sa), 2 * M_PI - fabs(angle - sa)),
+                                         std::min(fabs(angle - ea), 2 * M_PI - fabs(angle - ea)));
+                if (margin > 1e-6 && inside != (sink.pixels.count(p) > 0)) arcMismatches++;
+            }
+        }
+        bool ok = walkOk && whole.pixels == full.pixels && tipsOk && arcMismatches == 0;
+        if (!ok) {
+            printf("  ellipse %dx%d FAILED: walk %s, full arc %s, tips %s, %d arc mismatches\n", rx, ry,
+                   walkOk ? "ok" : "broken", whole.pixels == full.pixels ? "ok" : "differs",
+                   tipsOk ? "ok" : "missing", arcMismatches);
+            failures++;
+        }
+    }
+    printf("%zu ellipses (thin ones included), %zu arc pixels checked against atan2: %s\n",
+           sizeof(SHAPES) / sizeof(SHAPES[0]), arcPixels, failures ? "FAILED" : "ok");
+    return failures;
+}
+
+// The arc as drawn before the octant walk: every point of the full
+// midpoint circle, kept when its atan2 angle is in range
+template <typename Sink>
+void drawCircleArcAtan2(int cx, int cy, int r, double sa, double ea, Sink& sink) {
+    while (sa < 0) sa += 2 * M_PI;
+    while (ea < 0) ea += 2 * M_PI;
+    sa = fmod(sa, 2 * M_PI);
+    ea = fmod(ea, 2 * M_PI);
+    if (ea < sa) ea += 2 * M_PI;
+
+    auto plot = [&](int x, int y) {
+        double a = polarAngle(x, y);
+        while (a < sa) a += 2 * M_PI;
+        while (a > ea) a -= 2 * M_PI;
+        if (a >= sa && a <= ea) sink.plot(cx + x, cy + y);
+    };
+
+    int x = 0, y = r, p = 1 - r;
+    while (x <= y) {
+        plot(x, y); plot(y, x); plot(-x, y); plot(-y, x);
+        plot(-x, -y); plot(-y, -x); plot(x, -y); plot(y, -x);
+        x++;
+        if (p < 0) p += 2 * x + 1;
+        else { y--; p += 2 * (x - y) + 1; }
+    }
+}
+
+// Circle arcs against the atan2 arc, drawn once with the radius missing
+// from circleCache and once with it cached. Pixels within 1e-6 rad of a
+// boundary may go either way. Returns the number of failed checks.
+int checkCircleArcs() {
+    const int RADII[] = {1, 2, 5, 17, 100, 333, 1000};
+    const double ARCS[][2] = {{0, M_PI / 3}, {-M_PI / 6, M_PI / 12}, {7 * M_PI / 6, 11 * M_PI / 6},
+                              {M_PI / 4, M_PI / 2}, {5.5, 0.4}, {0.3, 0.31}, {0, 2 * M_PI - 1e-12}};
+    int failures = 0;
+    size_t arcPixels = 0;
+    for (int r : RADII) {
+        for (const auto& arc : ARCS) {
+            double sa = fmod(arc[0] + 2 * M_PI, 2 * M_PI), ea = fmod(arc[1] + 2 * M_PI, 2 * M_PI);
+            PixelSetSink reference, direct, cached;
+            drawCircleArcAtan2(0, 0, r, arc[0], arc[1], reference);
+            circleCache = CircleOffsetCache(1 << 20);
+            drawCircleArc(0, 0, r, arc[0], arc[1], direct);
+            circleCache.get(MIDPOINT_CIRCLE, r);
+            drawCircleArc(0, 0, r, arc[0], arc[1], cached);
+            arcPixels += reference.pixels.size();
+
+            std::set<std::pair<int, int>> candidates = reference.pixels;
+            candidates.insert(direct.pixels.begin(), direct.pixels.end());
+            int mismatches = 0;
+            for (const auto& p : candidates) {
+                double angle = polarAngle(p.first, p.second);
+                double margin = std::min(std::min(fabs(angle - sa), 2 * M_PI - fabs(angle - sa)),
+                                         std::min(fabs(angle - ea), 2 * M_PI - fabs(angle - ea)));
+                if (margin > 1e-6 && reference.pixels.count(p) != direct.pixels.count(p)) mismatches++;
+            }
+            if (mismatches || direct.pixels != cached.pixels) {
+                printf("  arc r=%d [%.3f, %.3f] FAILED: %d mismatches vs atan2, cached %s\n", r, arc[0],
+                       arc[1], mismatches, direct.pixels == cached.pixels ? "same" : "differs");
+                failures++;
+            }
+        }
+    }
+    // Negative radii draw nothing and stay out of the cache
+    circleCache = CircleOffsetCache(1 << 20);
+    PixelSetSink negative;
+    Framebuffer blank(64, 64), negativeFill(64, 64);
+    for (int r : {-1, -4, -10}) {
+        drawBresenhamCircle(32, 32, r, negative);
+        drawCircleArc(32, 32, r, 0, M_PI, negative);
+        fillDisc(32, 32, r, negativeFill);
+        fillAnnulus(32, 32, r, 8, negativeFill);
+    }
+    if (!negative.pixels.empty() || negativeFill.pixels != blank.pixels || circleCache.entries() != 0) {
+        printf("  negative radii FAILED: %zu outline pixels, %zu cache entries\n", negative.pixels.size(),
+               circleCache.entries());
+        failures++;
+    }
+    circleCache = CircleOffsetCache(1 << 20);
+    printf("%zu circle arcs, %zu pixels checked against atan2, cached and uncached: %s\n",
+           sizeof(RADII) / sizeof(RADII[0]) * sizeof(ARCS) / sizeof(ARCS[0]), arcPixels,
+           failures ? "FAILED" : "ok");
+    return failures;
+}
+
+// Small arcs cost their length rather than the circumference, with or
+// without the radius in circleCache
+void benchCircleArcs(Framebuffer& fb) {
+    const int ARCS = 20000;
+    CircleScene scene = makeRandomCircles(ARCS, fb.width, fb.height, {100}, 5);
+    for (int i = 0; i < ARCS; i++) scene.r[i] = 100 + i % 400;
+    auto timeArcs = [&](const char* name, double span, bool atan2Arc) {
+        fb.clear();
+        size_t hits = circleCache.hits, misses = circleCache.misses;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ARCS; i++) {
+            double sa = (i % 360) * M_PI / 180;
+            if (atan2Arc) drawCircleArcAtan2(scene.cx[i], scene.cy[i], scene.r[i], sa, sa + span, fb);
+            else drawCircleArc(scene.cx[i], scene.cy[i], scene.r[i], sa, sa + span, fb);
+        }
+        double seconds = secondsSince(start);
+        printf("%-22s %8.2f ms  hits %7zu  misses %7zu\n", name, seconds * 1e3, circleCache.hits - hits,
+               circleCache.misses - misses);
+    };
+    printf("%d arcs, r = 100..499\n", ARCS);
+    circleCache = CircleOffsetCache(1 << 20);
+    timeArcs("10 deg arc, uncached", M_PI / 18, false);
+    timeArcs("full circle, uncached", 2 * M_PI - 1e-9, false);
+    for (int r = 100; r < 500; r++) circleCache.get(MIDPOINT_CIRCLE, r);
+    timeArcs("10 deg arc, cached", M_PI / 18, false);
+    timeArcs("full circle, cached", 2 * M_PI - 1e-9, false);
+    timeArcs("10 deg arc, atan2", M_PI / 18, true);
+    circleCache = CircleOffsetCache(1 << 20);
+}
+
+int runBenchmark() {
+    int failures = checkEllipses() + checkCircleArcs();
+
+    const int W = 1024, H = 1024, COUNT = 50000;
+    Framebuffer fb(W, H);
+    std::vector<int> radii = {4, 8, 16, 32, 64, 128, 256};
+    CircleScene scene = makeRandomCircles(COUNT, W, H, radii, 1);
+    printf("%d circles with %zu distinct radii into a %dx%d framebuffer\n",
+           COUNT, radii.size(), W, H);
+    benchCircleCache("no cache", scene, 0, fb);
+    Framebuffer uncached = fb;
+    benchCircleCache("1 KiB cache", scene, 1 << 10, fb);
+    benchCircleCache("1 MiB cache", scene, 1 << 20, fb);
+    printf("  cached output matches uncached: %s\n", fb.pixels == uncached.pixels ? "yes" : "NO");
+    failures += fb.pixels != uncached.pixels;
+    circleCache = CircleOffsetCache(1 << 20);
+    benchCircleArcs(fb);
+
+    // Filled shapes, counted in filled pixels per second
+    const int FILLS = 20000;
+    CircleScene discs = makeRandomCircles(FILLS, W, H, {8, 32, 96}, 2);
+    long long filled = 0;
+    std::vector<int> hw;
+    for (int i = 0; i < FILLS; i++) {
+        circleHalfWidths(*circleCache.get(MIDPOINT_CIRCLE, discs.r[i]), discs.r[i], hw);
+        filled += 2 * hw[0] + 1;
+        for (int v = 1; v <= discs.r[i]; v++) filled += 2 * (2 * hw[v] + 1);
+    }
+    printf("%d filled discs (r = 8, 32, 96), %.1f Mpixels\n", FILLS, filled / 1e6);
+    fb.clear();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FILLS; i++) {
+        circleHalfWidths(*circleCache.get(MIDPOINT_CIRCLE, discs.r[i]), discs.r[i], hw);
+        for (int v = -discs.r[i]; v <= discs.r[i]; v++) {
+            for (int u = -hw[abs(v)]; u <= hw[abs(v)]; u++) fb.plot(discs.cx[i] + u, discs.cy[i] + v);
+        }
+    }
+    double perPixel = secondsSince(start);
+    Framebuffer pointByPoint = fb;
+    fb.clear();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FILLS; i++) fillDisc(discs.cx[i], discs.cy[i], discs.r[i], fb);
+    double spans = secondsSince(start);
+    printf("%-22s %10.1f Mpixels/s\n", "disc point by point", filled / perPixel / 1e6);
+    printf("%-22s %10.1f Mpixels/s\n", "disc span fill", filled / spans / 1e6);
+    printf("  span fill matches point by point: %s\n", fb.pixels == pointByPoint.pixels ? "yes" : "NO");
+    failures += fb.pixels != pointByPoint.pixels;
+
+    fb.clear();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FILLS; i++) fillAnnulus(discs.cx[i], discs.cy[i], discs.r[i] / 2, discs.r[i], fb);
+    double rings = secondsSince(start);
+    long long ringPixels = 0;
+    std::vector<int> hole;
+    for (int i = 0; i < FILLS; i++) {
+        int ro = discs.r[i], ri = ro / 2;
+        circleHalfWidths(*circleCache.get(MIDPOINT_CIRCLE, ro), ro, hw);
+        circleHoleWidths(*circleCache.get(MIDPOINT_CIRCLE, ri), ri, hole);
+        for (int v = -ro; v <= ro; v++) {
+            int a = abs(v);
+            ringPixels += (a <= ri && hole[a] > 0) ? 2 * (hw[a] - hole[a] + 1) : 2 * hw[a] + 1;
+        }
+    }
+    printf("%-22s %10.1f Mpixels/s\n", "annulus r/2..r", ringPixels / rings / 1e6);
+
+    // Particle scene through the band-parallel renderer
+    const int PARTICLES = 200000;
+    CircleScene particles = makeRandomCircles(PARTICLES, W, H, {2, 3, 5, 8, 12, 20, 40}, 4);
+    std::vector<CircleInstance> instances;
+    for (int i = 0; i < PARTICLES; i++) {
+        instances.push_back(CircleInstance{particles.cx[i], particles.cy[i], particles.r[i]});
+    }
+    fb.clear();
+    start = std::chrono::steady_clock::now();
+    for (const CircleInstance& c : instances) drawBresenhamCircle(c.cx, c.cy, c.r, fb);
+    double serial = secondsSince(start);
+    Framebuffer reference = fb;
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    printf("%d particle circles, 64-row bands, serial %.2f ms\n", PARTICLES, serial * 1e3);
+    for (int threads = 1; threads <= maxThreads; threads = (threads == maxThreads) ? threads + 1
+                                                             : std::min(threads * 2, maxThreads)) {
+        ThreadPool pool(threads);
+        BulkCircleRenderer renderer(64);
+        double best = 1e30;
+        for (int run = 0; run < 5; run++) {
+            fb.clear();
+            start = std::chrono::steady_clock::now();
+            renderer.render(instances.data(), PARTICLES, fb, pool);
+            best = std::min(best, secondsSince(start));
+        }
+        printf("  %2d threads %8.2f ms %6.2fx vs serial  matches serial: %s\n", threads, best * 1e3,
+               serial / best, fb.pixels == reference.pixels ? "yes" : "NO");
+        failures += fb.pixels != reference.pixels;
+    }
+    return failures ? 1 : 0;
+}
+
 int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) return runBenchmark();
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
@@ -143,6 +1005,7 @@ int main(int argc, char** argv) {
     init();
     std::cout << "Static Circle Arc Demo (WSL Ready)\n";
     std::cout << "Arc center: (400, 300), radius: 200, start angle: -30 deg, end angle: 15 deg\n";
+    std::cout << "Elliptical arc: rx 260, ry 100, start angle: 210 deg, end angle: 330 deg\n";
 
     // Create second window for Bresenham circle only
     glutInitWindowPosition(950, 100);
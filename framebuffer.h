@@ -0,0 +1,105 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Packed 0x00RRGGBB software framebuffer that needs no GL context.
+// Pixel (0, 0) sits at world coordinate (originX, originY) and rows are
+// stored bottom-up, the same way OpenGL lays out a window.
+struct Framebuffer {
+    int width, height;
+    int originX, originY;
+    uint32_t color;
+    std::vector<uint32_t> pixels;
+
+    Framebuffer(int w, int h, int ox = 0, int oy = 0)
+        : width(w), height(h), originX(ox), originY(oy), color(0xFFFFFF),
+          pixels((size_t)w * h, 0) {}
+
+    // Same argument convention as glColor3f
+    void setColor(float r, float g, float b) {
+        color = ((uint32_t)(r * 255.0f + 0.5f) << 16) |
+                ((uint32_t)(g * 255.0f + 0.5f) << 8) |
+                (uint32_t)(b * 255.0f + 0.5f);
+    }
+
+    void clear(uint32_t c = 0) {
+        std::fill(pixels.begin(), pixels.end(), c);
+    }
+
+    // Pixel sink interface shared by all rasterizers: off-screen pixels
+    // are discarded. Unsigned arithmetic folds both bounds into one test.
+    void plot(int x, int y) {
+        unsigned px = (unsigned)x - (unsigned)originX;
+        unsigned py = (unsigned)y - (unsigned)originY;
+        if (px < (unsigned)width && py < (unsigned)height) {
+            pixels[(size_t)py * width + px] = color;
+        }
+    }
+
+    // Horizontal run from xa to xb (inclusive, either order), clipped
+    void hspan(int y, int xa, int xb) {
+        if (xa > xb) std::swap(xa, xb);
+        long long py = (long long)y - originY;
+        if (py < 0 || py >= height) return;
+        long long a = std::max((long long)xa - originX, 0LL);
+        long long b = std::min((long long)xb - originX, (long long)width - 1);
+        if (a > b) return;
+        fillRow(&pixels[(size_t)py * width + a], (size_t)(b - a + 1));
+    }
+
+    // Vertical run from ya to yb (inclusive, either order), clipped
+    void vspan(int x, int ya, int yb) {
+        if (ya > yb) std::swap(ya, yb);
+        long long px = (long long)x - originX;
+        if (px < 0 || px >= width) return;
+        long long a = std::max((long long)ya - originY, 0LL);
+        long long b = std::min((long long)yb - originY, (long long)height - 1);
+        uint32_t* p = &pixels[px];
+        for (long long py = a; py <= b; py++) p[(size_t)py * width] = color;
+    }
+
+    // Stores n copies of color, 8 (AVX2) or 4 (SSE2) pixels per store
+    void fillRow(uint32_t* p, size_t n) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        __m256i c8 = _mm256_set1_epi32((int)color);
+        for (; i + 8 <= n; i += 8) _mm256_storeu_si256((__m256i*)(p + i), c8);
+#endif
+#if defined(__SSE2__) || defined(__AVX2__)
+        __m128i c4 = _mm_set1_epi32((int)color);
+        for (; i + 4 <= n; i += 4) _mm_storeu_si128((__m128i*)(p + i), c4);
+#endif
+        for (; i < n; i++) p[i] = color;
+    }
+
+    uint32_t at(int x, int y) const {
+        return pixels[(size_t)(y - originY) * width + (x - originX)];
+    }
+
+    // Binary PPM (P6), written top row first
+    bool writePPM(const char* path) const {
+        FILE* f = fopen(path, "wb");
+        if (!f) return false;
+        fprintf(f, "P6\n%d %d\n255\n", width, height);
+        std::vector<unsigned char> row((size_t)width * 3);
+        for (int y = height - 1; y >= 0; y--) {
+            const uint32_t* src = &pixels[(size_t)y * width];
+            for (int x = 0; x < width; x++) {
+                row[x * 3 + 0] = (src[x] >> 16) & 0xFF;
+                row[x * 3 + 1] = (src[x] >> 8) & 0xFF;
+                row[x * 3 + 2] = src[x] & 0xFF;
+            }
+            fwrite(row.data(), 1, row.size(), f);
+        }
+        return fclose(f) == 0;
+    }
+};
+
+#endif
@@ -2,6 +2,20 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <cstdint>
+#include <algorithm>
+#include <map>
+#include <set>
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "framebuffer.h"
+#include "thread_pool.h"
 
 #define M_PI 3.14159265358979323846
 
@@ -43,13 +57,16 @@ struct Line {
 // Polygon structure (renamed to MyPolygon to avoid conflict with Windows API)
 struct MyPolygon {
     std::vector<Point> vertices;
+    unsigned version = 0; // bumped on every change, for caches
     
     void addVertex(int x, int y) {
         vertices.push_back(Point(x, y));
+        version++;
     }
     
     void clear() {
         vertices.clear();
+        version++;
     }
 };
 
@@ -65,8 +82,17 @@ struct ClippingRect {
 MyPolygon polygon;
 MyPolygon clippedPolygon;
 ClippingRect clipRect(100, 100, 300, 500);
+unsigned clipRectVersion = 0;
 bool drawingPolygon = false;
 bool polygonClosed = false;
+bool draggingRect = false;
+int dragX, dragY;
+
+// Every change of clipRect goes through here so caches see it
+void setClipRect(const ClippingRect& rect) {
+    clipRect = rect;
+    clipRectVersion++;
+}
 
 // Function to compute region code for a point
 int computeRegionCode(int x, int y, const ClippingRect& rect) {
@@ -85,6 +111,25 @@ int computeRegionCode(int x, int y, const ClippingRect& rect) {
     return code;
 }
 
+// Region code of a point that is not on the pixel grid, such as an
+// intersection with a boundary. Truncating it to int first would call a
+// point just outside the left or bottom edge inside.
+int computeRegionCode(double x, double y, const ClippingRect& rect) {
+    int code = INSIDE;
+    
+    if (x < rect.xmin)
+        code |= LEFT;
+    else if (x > rect.xmax)
+        code |= RIGHT;
+    
+    if (y < rect.ymin)
+        code |= BOTTOM;
+    else if (y > rect.ymax)
+        code |= TOP;
+    
+    return code;
+}
+
 // Cohen-Sutherland line clipping algorithm
 bool clipLine(Line& line, const ClippingRect& rect, Line& clippedLine) {
     double x1 = line.start.x;
@@ -92,8 +137,8 @@ bool clipLine(Line& line, const ClippingRect& rect, Line& clippedLine) {
     double x2 = line.end.x;
     double y2 = line.end.y;
     
-    int code1 = computeRegionCode((int)x1, (int)y1, rect);
-    int code2 = computeRegionCode((int)x2, (int)y2, rect);
+    int code1 = computeRegionCode(x1, y1, rect);
+    int code2 = computeRegionCode(x2, y2, rect);
     
     bool accept = false;
     
@@ -136,11 +181,11 @@ bool clipLine(Line& line, const ClippingRect& rect, Line& clippedLine) {
             if (code == code1) {
                 x1 = x;
                 y1 = y;
-                code1 = computeRegionCode((int)x1, (int)y1, rect);
+                code1 = computeRegionCode(x1, y1, rect);
             } else {
                 x2 = x;
                 y2 = y;
-                code2 = computeRegionCode((int)x2, (int)y2, rect);
+                code2 = computeRegionCode(x2, y2, rect);
             }
         }
     }
@@ -152,38 +197,744 @@ bool clipLine(Line& line, const ClippingRect& rect, Line& clippedLine) {
     return accept;
 }
 
-// Function to clip a polygon using the Sutherland-Hodgman algorithm
-void clipPolygon() {
-    if (polygon.vertices.size() < 3) return; // Need at least a triangle
-    
-    clippedPolygon.clear();
-    
-    // Create a vector of lines from polygon vertices
-    std::vector<Line> lines;
-    for (size_t i = 0; i < polygon.vertices.size(); i++) {
-        size_t next = (i + 1) % polygon.vertices.size();
-        lines.push_back(Line(polygon.vertices[i], polygon.vertices[next]));
+// Vertex handed to and produced by PolygonClipper
+struct ClipVertex {
+    double x, y;
+};
+
+// Sutherland-Hodgman clipping against a rectangle as four chained stages
+// (left, right, bottom, top). Each vertex is pushed through the stages as
+// soon as it is read: a stage only remembers its first and previous vertex,
+// so no intermediate polygon is ever stored and a clip allocates nothing.
+// Corners of the rectangle that the polygon wraps around come out as the
+// intersections of consecutive stages.
+class PolygonClipper {
+public:
+    explicit PolygonClipper(const ClippingRect& rect) { setRect(rect); }
+
+    void setRect(const ClippingRect& rect) {
+        bounds[0] = rect.xmin;
+        bounds[1] = rect.xmax;
+        bounds[2] = rect.ymin;
+        bounds[3] = rect.ymax;
     }
-    
-    // Clip each line and collect the resulting points
-    std::vector<Point> clipPoints;
-    for (auto& line : lines) {
-        Line clippedLine(Point(0, 0), Point(0, 0));
-        if (clipLine(line, clipRect, clippedLine)) {
-            clipPoints.push_back(clippedLine.start);
+
+    // Clips the closed polygon vertex(0) .. vertex(n - 1) and calls
+    // emit(x, y) for every output vertex in order
+    template <typename Vertex, typename Emit>
+    void clip(size_t n, Vertex vertex, Emit emit) {
+        for (int s = 0; s < STAGES; s++) stages[s].started = false;
+        for (size_t i = 0; i < n; i++) {
+            ClipVertex v = vertex(i);
+            push(0, v.x, v.y, emit);
+        }
+        close(0, emit);
+    }
+
+private:
+    static const int STAGES = 4;
+
+    struct Stage {
+        double firstX, firstY;
+        double prevX, prevY;
+        bool started;
+    };
+
+    double bounds[STAGES];
+    Stage stages[STAGES];
+
+    // Stage s keeps x >= xmin, x <= xmax, y >= ymin, y <= ymax in turn
+    bool inside(int s, double x, double y) const {
+        switch (s) {
+        case 0: return x >= bounds[0];
+        case 1: return x <= bounds[1];
+        case 2: return y >= bounds[2];
+        default: return y <= bounds[3];
+        }
+    }
+
+    // Point where the segment crosses the boundary of stage s
+    ClipVertex intersect(int s, double x0, double y0, double x1, double y1) const {
+        if (s < 2) {
+            double t = (bounds[s] - x0) / (x1 - x0);
+            return ClipVertex{ bounds[s], y0 + t * (y1 - y0) };
+        }
+        double t = (bounds[s] - y0) / (y1 - y0);
+        return ClipVertex{ x0 + t * (x1 - x0), bounds[s] };
+    }
+
+    // Output of the edge from the previous vertex of stage s to (x, y)
+    template <typename Emit>
+    void edge(int s, double x, double y, Emit& emit) {
+        Stage& st = stages[s];
+        bool in = inside(s, x, y);
+        if (in != inside(s, st.prevX, st.prevY)) {
+            ClipVertex c = intersect(s, st.prevX, st.prevY, x, y);
+            push(s + 1, c.x, c.y, emit);
+        }
+        if (in) push(s + 1, x, y, emit);
+    }
+
+    template <typename Emit>
+    void push(int s, double x, double y, Emit& emit) {
+        if (s == STAGES) {
+            emit(x, y);
+            return;
+        }
+        Stage& st = stages[s];
+        if (!st.started) {
+            st.firstX = x;
+            st.firstY = y;
+            st.started = true;
+        } else {
+            edge(s, x, y, emit);
+        }
+        st.prevX = x;
+        st.prevY = y;
+    }
+
+    // Closing edge from the last vertex back to the first, then the next stage
+    template <typename Emit>
+    void close(int s, Emit& emit) {
+        if (s == STAGES) return;
+        Stage& st = stages[s];
+        if (st.started) edge(s, st.firstX, st.firstY, emit);
+        close(s + 1, emit);
+    }
+};
+
+PolygonClipper polygonClipper(clipRect);
+
+// Many polygons in structure-of-arrays form: polygon p is made of vertices
+// offsets[p] .. offsets[p + 1] - 1 of x and y
+struct PolygonSoA {
+    std::vector<double> x, y;
+    std::vector<int> offsets{0};
+
+    int count() const { return (int)offsets.size() - 1; }
+    size_t vertexCount() const { return x.size(); }
+};
+
+// Clips every polygon of a PolygonSoA against one rectangle on a thread
+// pool. Polygons are handed out in fixed chunks; each chunk is clipped
+// into its own buffer, per-polygon output counts are prefix-summed into
+// the output offsets, and the chunks are copied into place in parallel.
+// Chunk buffers and the output keep their capacity between calls, so a
+// steady stream of similar batches does not allocate.
+class BatchPolygonClipper {
+public:
+    explicit BatchPolygonClipper(ThreadPool& threadPool, int chunkPolygons = 1024)
+        : pool(threadPool), chunkSize(chunkPolygons),
+          clippers(threadPool.size(), PolygonClipper(ClippingRect(0, 0, 0, 0))) {}
+
+    void clip(const PolygonSoA& in, const ClippingRect& rect, PolygonSoA& out) {
+        int polygons = in.count();
+        int chunks = (polygons + chunkSize - 1) / chunkSize;
+        if ((int)chunkOutput.size() < chunks) chunkOutput.resize(chunks);
+        for (PolygonClipper& clipper : clippers) clipper.setRect(rect);
+        out.offsets.resize(polygons + 1);
+        
+        // Clip: output counts land in out.offsets[p + 1] for the prefix sum
+        pool.parallelFor(chunks, [&](int c, int worker) {
+            ChunkOutput& buffer = chunkOutput[c];
+            buffer.x.clear();
+            buffer.y.clear();
+            PolygonClipper& clipper = clippers[worker];
+            int end = std::min(polygons, (c + 1) * chunkSize);
+            for (int p = c * chunkSize; p < end; p++) {
+                const double* px = in.x.data() + in.offsets[p];
+                const double* py = in.y.data() + in.offsets[p];
+                size_t before = buffer.x.size();
+                clipper.clip(in.offsets[p + 1] - in.offsets[p],
+                             [&](size_t i) { return ClipVertex{ px[i], py[i] }; },
+                             [&](double x, double y) {
+                                 buffer.x.push_back(x);
+                                 buffer.y.push_back(y);
+                             });
+                out.offsets[p + 1] = (int)(buffer.x.size() - before);
+            }
+        });
+        
+        out.offsets[0] = 0;
+        for (int p = 0; p < polygons; p++) out.offsets[p + 1] += out.offsets[p];
+        out.x.resize(out.offsets[polygons]);
+        out.y.resize(out.offsets[polygons]);
+        
+        pool.parallelFor(chunks, [&](int c, int) {
+            const ChunkOutput& buffer = chunkOutput[c];
+            size_t start = out.offsets[c * chunkSize];
+            std::copy(buffer.x.begin(), buffer.x.end(), out.x.begin() + start);
+            std::copy(buffer.y.begin(), buffer.y.end(), out.y.begin() + start);
+        });
+    }
+
+private:
+    struct ChunkOutput {
+        std::vector<double> x, y;
+    };
+
+    ThreadPool& pool;
+    int chunkSize;
+    std::vector<PolygonClipper> clippers;
+    std::vector<ChunkOutput> chunkOutput;
+};
+
+// Many line segments in structure-of-arrays form
+struct LineSoA {
+    std::vector<int> x0, y0, x1, y1;
+
+    size_t size() const { return x0.size(); }
+
+    void resize(size_t n) {
+        x0.resize(n);
+        y0.resize(n);
+        x1.resize(n);
+        y1.resize(n);
+    }
+};
+
+// Region codes of n points, 8 (AVX2) or 4 (SSE2) points per instruction.
+// Same codes as computeRegionCode.
+void computeRegionCodes(const int* xs, const int* ys, size_t n, const ClippingRect& rect, int32_t* codes) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    {
+        const __m256i xmin = _mm256_set1_epi32(rect.xmin), xmax = _mm256_set1_epi32(rect.xmax);
+        const __m256i ymin = _mm256_set1_epi32(rect.ymin), ymax = _mm256_set1_epi32(rect.ymax);
+        const __m256i left = _mm256_set1_epi32(LEFT), right = _mm256_set1_epi32(RIGHT);
+        const __m256i bottom = _mm256_set1_epi32(BOTTOM), top = _mm256_set1_epi32(TOP);
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(xs + i));
+            __m256i y = _mm256_loadu_si256((const __m256i*)(ys + i));
+            __m256i code = _mm256_or_si256(
+                _mm256_or_si256(_mm256_and_si256(_mm256_cmpgt_epi32(xmin, x), left),
+                                _mm256_and_si256(_mm256_cmpgt_epi32(x, xmax), right)),
+                _mm256_or_si256(_mm256_and_si256(_mm256_cmpgt_epi32(ymin, y), bottom),
+                                _mm256_and_si256(_mm256_cmpgt_epi32(y, ymax), top)));
+            _mm256_storeu_si256((__m256i*)(codes + i), code);
+        }
+    }
+#endif
+#if defined(__SSE2__) || defined(__AVX2__)
+    {
+        const __m128i xmin = _mm_set1_epi32(rect.xmin), xmax = _mm_set1_epi32(rect.xmax);
+        const __m128i ymin = _mm_set1_epi32(rect.ymin), ymax = _mm_set1_epi32(rect.ymax);
+        const __m128i left = _mm_set1_epi32(LEFT), right = _mm_set1_epi32(RIGHT);
+        const __m128i bottom = _mm_set1_epi32(BOTTOM), top = _mm_set1_epi32(TOP);
+        for (; i + 4 <= n; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(xs + i));
+            __m128i y = _mm_loadu_si128((const __m128i*)(ys + i));
+            __m128i code = _mm_or_si128(
+                _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi32(xmin, x), left),
+                             _mm_and_si128(_mm_cmpgt_epi32(x, xmax), right)),
+                _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi32(ymin, y), bottom),
+                             _mm_and_si128(_mm_cmpgt_epi32(y, ymax), top)));
+            _mm_storeu_si128((__m128i*)(codes + i), code);
+        }
+    }
+#endif
+    for (; i < n; i++) codes[i] = computeRegionCode(xs[i], ys[i], rect);
+}
+
+// Liang-Barsky clip of one segment that is neither trivially inside nor
+// trivially outside. The four boundaries are folded in with selects rather
+// than branches; a zero direction component gives an infinite ratio that
+// the selects ignore, and is rejected only if the line lies outside.
+bool clipLineParametric(int x0, int y0, int x1, int y1, const ClippingRect& rect,
+                        int& cx0, int& cy0, int& cx1, int& cy1) {
+    double dx = x1 - x0, dy = y1 - y0;
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { (double)x0 - rect.xmin, (double)rect.xmax - x0,
+                          (double)y0 - rect.ymin, (double)rect.ymax - y0 };
+    double t0 = 0, t1 = 1;
+    bool reject = false;
+    for (int k = 0; k < 4; k++) {
+        double r = q[k] / p[k];
+        t0 = p[k] < 0 ? std::max(t0, r) : t0;
+        t1 = p[k] > 0 ? std::min(t1, r) : t1;
+        reject |= (p[k] == 0) & (q[k] < 0);
+    }
+    cx0 = (int)std::lround(x0 + t0 * dx);
+    cy0 = (int)std::lround(y0 + t0 * dy);
+    cx1 = (int)std::lround(x0 + t1 * dx);
+    cy1 = (int)std::lround(y0 + t1 * dy);
+    return !reject && t0 <= t1;
+}
+
+// Clips a batch of lines: vectorized region codes sort out the trivially
+// inside and outside lines, the rest go through clipLineParametric. The
+// visible lines are written compacted to out, with the index of the line
+// they came from in source. Scratch arrays are kept between calls.
+// clipLine is the reference: both keep exactly the same lines, and a
+// clipped endpoint may differ from clipLine's by 1 px, where the two
+// round the same boundary intersection from differently computed values.
+class BatchLineClipper {
+public:
+    size_t clip(const LineSoA& in, const ClippingRect& rect, LineSoA& out, std::vector<int>& source) {
+        size_t n = in.size();
+        startCodes.resize(n);
+        endCodes.resize(n);
+        computeRegionCodes(in.x0.data(), in.y0.data(), n, rect, startCodes.data());
+        computeRegionCodes(in.x1.data(), in.y1.data(), n, rect, endCodes.data());
+        
+        out.resize(n);
+        source.resize(n);
+        size_t visible = 0;
+        for (size_t i = 0; i < n; i++) {
+            int code0 = startCodes[i], code1 = endCodes[i];
+            if (code0 & code1) continue;
+            if ((code0 | code1) == 0) {
+                out.x0[visible] = in.x0[i];
+                out.y0[visible] = in.y0[i];
+                out.x1[visible] = in.x1[i];
+                out.y1[visible] = in.y1[i];
+            } else if (!clipLineParametric(in.x0[i], in.y0[i], in.x1[i], in.y1[i], rect,
+                                           out.x0[visible], out.y0[visible],
+                                           out.x1[visible], out.y1[visible])) {
+                continue;
+            }
+            source[visible++] = (int)i;
+        }
+        out.resize(visible);
+        source.resize(visible);
+        return visible;
+    }
+
+private:
+    std::vector<int32_t> startCodes, endCodes;
+};
+
+// Twice the signed area of a polygon; positive when counter-clockwise
+double signedArea2(const std::vector<ClipVertex>& poly) {
+    double sum = 0;
+    for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+        sum += poly[j].x * poly[i].y - poly[i].x * poly[j].y;
+    }
+    return sum;
+}
+
+// Even-odd point in polygon test
+bool pointInPolygon(double x, double y, const std::vector<ClipVertex>& poly) {
+    bool in = false;
+    for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+        const ClipVertex& a = poly[j];
+        const ClipVertex& b = poly[i];
+        if ((a.y > y) != (b.y > y) && x < a.x + (y - a.y) / (b.y - a.y) * (b.x - a.x)) in = !in;
+    }
+    return in;
+}
+
+// Clip window bounded by any convex polygon, e.g. a rotated view. Each
+// edge is kept as a point and inward normal, so "inside edge k" is
+// normal[k] . (q - point[k]) >= 0.
+class ConvexClipWindow {
+public:
+    explicit ConvexClipWindow(const std::vector<ClipVertex>& vertices) : points(vertices) {
+        if (signedArea2(points) < 0) std::reverse(points.begin(), points.end());
+        for (size_t i = 0; i < points.size(); i++) {
+            const ClipVertex& a = points[i];
+            const ClipVertex& b = points[(i + 1) % points.size()];
+            normals.push_back(ClipVertex{ a.y - b.y, b.x - a.x });
+        }
+    }
+
+    // Cyrus-Beck: the parametric clip of Liang-Barsky with one term per
+    // window edge instead of four axis-aligned ones
+    bool clipLine(ClipVertex a, ClipVertex b, ClipVertex& outA, ClipVertex& outB) const {
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double t0 = 0, t1 = 1;
+        for (size_t k = 0; k < points.size(); k++) {
+            double num = normals[k].x * (a.x - points[k].x) + normals[k].y * (a.y - points[k].y);
+            double den = normals[k].x * dx + normals[k].y * dy;
+            if (den == 0) {
+                if (num < 0) return false;
+            } else if (den > 0) {
+                t0 = std::max(t0, -num / den);
+            } else {
+                t1 = std::min(t1, -num / den);
+            }
+        }
+        if (t0 > t1) return false;
+        outA = ClipVertex{ a.x + t0 * dx, a.y + t0 * dy };
+        outB = ClipVertex{ a.x + t1 * dx, a.y + t1 * dy };
+        return true;
+    }
+
+    // Sutherland-Hodgman against every window edge in turn. The number of
+    // stages depends on the window, so the polygon is passed between two
+    // buffers that are reused from call to call.
+    void clipPolygon(const std::vector<ClipVertex>& subject, std::vector<ClipVertex>& out) {
+        out = subject;
+        for (size_t k = 0; k < points.size() && !out.empty(); k++) {
+            scratch.swap(out);
+            out.clear();
+            for (size_t i = 0, j = scratch.size() - 1; i < scratch.size(); j = i++) {
+                const ClipVertex& prev = scratch[j];
+                const ClipVertex& cur = scratch[i];
+                double dPrev = distance(k, prev), dCur = distance(k, cur);
+                if ((dCur >= 0) != (dPrev >= 0)) {
+                    double t = dPrev / (dPrev - dCur);
+                    out.push_back(ClipVertex{ prev.x + t * (cur.x - prev.x), prev.y + t * (cur.y - prev.y) });
+                }
+                if (dCur >= 0) out.push_back(cur);
+            }
+        }
+    }
+
+private:
+    std::vector<ClipVertex> points, normals;
+    std::vector<ClipVertex> scratch;
+
+    double distance(size_t k, const ClipVertex& q) const {
+        return normals[k].x * (q.x - points[k].x) + normals[k].y * (q.y - points[k].y);
+    }
+};
+
+// Greiner-Hormann intersection of two arbitrary polygons, concave or
+// self-intersecting (even-odd interior). Both polygons become circular
+// vertex lists with their mutual intersections spliced in; walking from
+// intersection to intersection, switching lists at each one, traces the
+// output. Candidate edge pairs come from a sweep over x: edges are sorted
+// by their left end and only pairs whose x and y extents overlap are
+// tested, which keeps polygons with tens of thousands of vertices fast.
+//
+// Vertices lying exactly on the other polygon's edges would need special
+// cases; instead the subject is shifted by a tiny, irrational-looking
+// offset relative to its size, which makes them vanishingly unlikely.
+class GreinerHormannClipper {
+public:
+    // Appends the pieces of subject AND clip to out
+    void intersect(const std::vector<ClipVertex>& subject, const std::vector<ClipVertex>& clip,
+                   PolygonSoA& out) {
+        out.x.clear();
+        out.y.clear();
+        out.offsets.assign(1, 0);
+        if (subject.size() < 3 || clip.size() < 3) return;
+        perturb(subject, clip);
+        findIntersections(shifted, clip);
+        
+        if (crossings.empty()) {
+            // Nested or disjoint
+            if (pointInPolygon(shifted[0].x, shifted[0].y, clip)) {
+                emitPolygon(subject, out);
+            } else if (pointInPolygon(clip[0].x, clip[0].y, shifted)) {
+                emitPolygon(clip, out);
+            }
+            return;
+        }
+        
+        nodes.clear();
+        buildRing(shifted, 0, clip);
+        buildRing(clip, 1, shifted);
+        trace(out);
+    }
+
+    // Edge pairs that passed the sweep prefilter in the last call
+    size_t pairsTested = 0;
+
+private:
+    struct Node {
+        double x, y;
+        int next, prev;
+        int neighbor;       // same intersection in the other ring, or -1
+        bool entry;
+        bool visited;
+    };
+
+    struct Crossing {
+        int edge[2];        // subject edge, clip edge
+        double alpha[2];    // position along each edge
+        double x, y;
+        int node[2];
+    };
+
+    struct SweepEdge {
+        double xmin, xmax, ymin, ymax;
+        int polygon, index;
+    };
+
+    std::vector<ClipVertex> shifted;
+    std::vector<Crossing> crossings;
+    std::vector<SweepEdge> edges;
+    std::vector<int> active[2];
+    std::vector<int> order;
+    std::vector<Node> nodes;
+
+    void perturb(const std::vector<ClipVertex>& subject, const std::vector<ClipVertex>& clip) {
+        double extent = 0;
+        for (const ClipVertex& v : clip) extent = std::max(extent, std::max(std::fabs(v.x), std::fabs(v.y)));
+        for (const ClipVertex& v : subject) extent = std::max(extent, std::max(std::fabs(v.x), std::fabs(v.y)));
+        double eps = std::max(extent, 1.0) * 1e-9;
+        shifted.resize(subject.size());
+        for (size_t i = 0; i < subject.size(); i++) {
+            shifted[i] = ClipVertex{ subject[i].x + eps * 0.7071067811865476, subject[i].y + eps * 0.5772156649015329 };
+        }
+    }
+
+    void addEdges(const std::vector<ClipVertex>& poly, int which) {
+        for (size_t i = 0; i < poly.size(); i++) {
+            const ClipVertex& a = poly[i];
+            const ClipVertex& b = poly[(i + 1) % poly.size()];
+            edges.push_back(SweepEdge{ std::min(a.x, b.x), std::max(a.x, b.x),
+                                       std::min(a.y, b.y), std::max(a.y, b.y), which, (int)i });
+        }
+    }
+
+    void findIntersections(const std::vector<ClipVertex>& subject, const std::vector<ClipVertex>& clip) {
+        const std::vector<ClipVertex>* polys[2] = { &subject, &clip };
+        edges.clear();
+        addEdges(subject, 0);
+        addEdges(clip, 1);
+        std::sort(edges.begin(), edges.end(),
+                  [](const SweepEdge& a, const SweepEdge& b) { return a.xmin < b.xmin; });
+        crossings.clear();
+        pairsTested = 0;
+        active[0].clear();
+        active[1].clear();
+        for (int e = 0; e < (int)edges.size(); e++) {
+            const SweepEdge& edge = edges[e];
+            std::vector<int>& others = active[1 - edge.polygon];
+            // Drop edges that end left of the sweep line, then test the rest
+            size_t kept = 0;
+            for (size_t k = 0; k < others.size(); k++) {
+                const SweepEdge& other = edges[others[k]];
+                if (other.xmax < edge.xmin) continue;
+                others[kept++] = others[k];
+                if (other.ymax < edge.ymin || other.ymin > edge.ymax) continue;
+                pairsTested++;
+                const SweepEdge& s = edge.polygon == 0 ? edge : other;
+                const SweepEdge& c = edge.polygon == 0 ? other : edge;
+                testEdges(*polys[0], s.index, *polys[1], c.index);
+            }
+            others.resize(kept);
+            active[edge.polygon].push_back(e);
+        }
+    }
+
+    void testEdges(const std::vector<ClipVertex>& subject, int i, const std::vector<ClipVertex>& clip, int j) {
+        const ClipVertex& a = subject[i];
+        const ClipVertex& b = subject[(i + 1) % subject.size()];
+        const ClipVertex& c = clip[j];
+        const ClipVertex& d = clip[(j + 1) % clip.size()];
+        double rx = b.x - a.x, ry = b.y - a.y, sx = d.x - c.x, sy = d.y - c.y;
+        double denom = rx * sy - ry * sx;
+        if (denom == 0) return;
+        double qx = c.x - a.x, qy = c.y - a.y;
+        double alphaS = (qx * sy - qy * sx) / denom;
+        double alphaC = (qx * ry - qy * rx) / denom;
+        if (alphaS <= 0 || alphaS >= 1 || alphaC <= 0 || alphaC >= 1) return;
+        crossings.push_back(Crossing{ { i, j }, { alphaS, alphaC }, a.x + alphaS * rx, a.y + alphaS * ry, { -1, -1 } });
+    }
+
+    // Ring `which` (0 subject, 1 clip): original vertices with the
+    // crossings of each edge spliced in by increasing alpha. Entry flags
+    // alternate along the ring, starting from whether vertex 0 lies
+    // inside the other polygon.
+    void buildRing(const std::vector<ClipVertex>& poly, int which, const std::vector<ClipVertex>& other) {
+        order.resize(crossings.size());
+        for (size_t k = 0; k < crossings.size(); k++) order[k] = (int)k;
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            const Crossing& ca = crossings[a];
+            const Crossing& cb = crossings[b];
+            if (ca.edge[which] != cb.edge[which]) return ca.edge[which] < cb.edge[which];
+            return ca.alpha[which] < cb.alpha[which];
+        });
+        int first = (int)nodes.size();
+        bool inside = pointInPolygon(poly[0].x, poly[0].y, other);
+        size_t k = 0;
+        for (int i = 0; i < (int)poly.size(); i++) {
+            nodes.push_back(Node{ poly[i].x, poly[i].y, 0, 0, -1, false, false });
+            for (; k < order.size() && crossings[order[k]].edge[which] == i; k++) {
+                Crossing& crossing = crossings[order[k]];
+                crossing.node[which] = (int)nodes.size();
+                nodes.push_back(Node{ crossing.x, crossing.y, 0, 0, -1, !inside, false });
+                inside = !inside;
+            }
+        }
+        int last = (int)nodes.size() - 1;
+        for (int n = first; n <= last; n++) {
+            nodes[n].next = n == last ? first : n + 1;
+            nodes[n].prev = n == first ? last : n - 1;
+        }
+        if (which == 1) {
+            for (const Crossing& crossing : crossings) {
+                nodes[crossing.node[0]].neighbor = crossing.node[1];
+                nodes[crossing.node[1]].neighbor = crossing.node[0];
+            }
+        }
+    }
+
+    // From each unvisited crossing, follow the current ring forward after
+    // an entry and backward after an exit, switching rings at every
+    // crossing, until the walk returns to where it started
+    void trace(PolygonSoA& out) {
+        for (const Crossing& crossing : crossings) {
+            int start = crossing.node[0];
+            if (nodes[start].visited) continue;
+            int current = start;
+            do {
+                nodes[current].visited = true;
+                nodes[nodes[current].neighbor].visited = true;
+                bool forward = nodes[current].entry;
+                do {
+                    out.x.push_back(nodes[current].x);
+                    out.y.push_back(nodes[current].y);
+                    current = forward ? nodes[current].next : nodes[current].prev;
+                } while (nodes[current].neighbor < 0);
+                current = nodes[current].neighbor;
+            } while (current != start && nodes[current].neighbor != start);
+            out.offsets.push_back((int)out.x.size());
+        }
+    }
+
+    static void emitPolygon(const std::vector<ClipVertex>& poly, PolygonSoA& out) {
+        for (const ClipVertex& v : poly) {
+            out.x.push_back(v.x);
+            out.y.push_back(v.y);
+        }
+        out.offsets.push_back((int)out.x.size());
+    }
+};
+
+// Interior rules for ScanlineFiller
+enum FillRule { FILL_EVEN_ODD, FILL_NONZERO };
+
+// Edge table / active edge table scan converter for any set of closed
+// contours: concave, self-intersecting, or with holes. Pixels whose
+// centers lie inside are filled with one hspan per interior run. Edges
+// are bucketed by their first row; a band of rows keeps its own active
+// edge list, so bands can be filled on different threads.
+class ScanlineFiller {
+public:
+    void fill(const PolygonSoA& contours, FillRule rule, Framebuffer& fb, ThreadPool* pool = nullptr,
+              int bandRows = 64) {
+        buildEdgeTable(contours);
+        int rowBegin = fb.originY, rowEnd = fb.originY + fb.height;
+        if (!edges.empty()) {
+            rowBegin = std::max(rowBegin, edges[byStart.front()].startRow);
+            rowEnd = std::min(rowEnd, lastRow);
+        }
+        if (edges.empty() || rowBegin >= rowEnd) return;
+        int bands = (rowEnd - rowBegin + bandRows - 1) / bandRows;
+        int workers = pool ? pool->size() : 1;
+        if ((int)scratch.size() < workers) scratch.resize(workers);
+        auto band = [&](int b, int worker) {
+            int r0 = rowBegin + b * bandRows;
+            fillRows(r0, std::min(r0 + bandRows, rowEnd), rule, fb, scratch[worker]);
+        };
+        if (pool) {
+            pool->parallelFor(bands, band);
+        } else {
+            for (int b = 0; b < bands; b++) band(b, 0);
+        }
+    }
+
+private:
+    struct Edge {
+        int startRow, endRow;   // rows whose pixel centers the edge spans
+        double x0, y0, dxdy;
+        int winding;            // +1 upward, -1 downward
+    };
+
+    struct Crossing {
+        double x;
+        int winding;
+        bool operator<(const Crossing& other) const { return x < other.x; }
+    };
+
+    struct Scratch {
+        std::vector<int> active;
+        std::vector<Crossing> crossings;
+    };
+
+    std::vector<Edge> edges;
+    std::vector<int> byStart;   // edge table: edge indices ordered by startRow
+    std::vector<Scratch> scratch;
+    int lastRow = 0;
+
+    // A row y is sampled at y + 0.5, so an edge from ya to yb (ya < yb)
+    // covers rows ceil(ya - 0.5) .. ceil(yb - 0.5) - 1. Horizontal edges
+    // and edges between two pixel centers cover none and are dropped.
+    void buildEdgeTable(const PolygonSoA& contours) {
+        edges.clear();
+        lastRow = INT32_MIN;
+        for (int c = 0; c < contours.count(); c++) {
+            int first = contours.offsets[c], last = contours.offsets[c + 1] - 1;
+            for (int i = first; i <= last; i++) {
+                int j = i == last ? first : i + 1;
+                double xa = contours.x[i], ya = contours.y[i], xb = contours.x[j], yb = contours.y[j];
+                int winding = 1;
+                if (ya > yb) {
+                    std::swap(xa, xb);
+                    std::swap(ya, yb);
+                    winding = -1;
+                }
+                int startRow = (int)std::ceil(ya - 0.5), endRow = (int)std::ceil(yb - 0.5);
+                if (startRow >= endRow) continue;
+                edges.push_back(Edge{ startRow, endRow, xa, ya, (xb - xa) / (yb - ya), winding });
+                lastRow = std::max(lastRow, endRow);
+            }
+        }
+        byStart.resize(edges.size());
+        for (size_t e = 0; e < edges.size(); e++) byStart[e] = (int)e;
+        std::sort(byStart.begin(), byStart.end(),
+                  [&](int a, int b) { return edges[a].startRow < edges[b].startRow; });
+    }
+
+    void fillRows(int r0, int r1, FillRule rule, Framebuffer& fb, Scratch& s) {
+        // Edges already running at the band's first row, then the ones
+        // starting inside the band as their rows come up
+        s.active.clear();
+        size_t next = 0;
+        for (; next < byStart.size() && edges[byStart[next]].startRow <= r0; next++) {
+            if (edges[byStart[next]].endRow > r0) s.active.push_back(byStart[next]);
+        }
+        for (int y = r0; y < r1; y++) {
+            for (; next < byStart.size() && edges[byStart[next]].startRow == y; next++) {
+                s.active.push_back(byStart[next]);
+            }
+            size_t kept = 0;
+            s.crossings.clear();
+            for (int e : s.active) {
+                const Edge& edge = edges[e];
+                if (edge.endRow <= y) continue;
+                s.active[kept++] = e;
+                s.crossings.push_back(Crossing{ edge.x0 + (y + 0.5 - edge.y0) * edge.dxdy, edge.winding });
+            }
+            s.active.resize(kept);
+            std::sort(s.crossings.begin(), s.crossings.end());
             
-            // Avoid duplicates
-            if (clipPoints.empty() || !(clipPoints.back() == clippedLine.end)) {
-                clipPoints.push_back(clippedLine.end);
+            int winding = 0;
+            for (size_t k = 0; k + 1 < s.crossings.size(); k++) {
+                winding += rule == FILL_EVEN_ODD ? 1 : s.crossings[k].winding;
+                bool inside = rule == FILL_EVEN_ODD ? (winding & 1) : winding != 0;
+                if (!inside) continue;
+                int xa = (int)std::ceil(s.crossings[k].x - 0.5);
+                int xb = (int)std::ceil(s.crossings[k + 1].x - 0.5) - 1;
+                if (xa <= xb) fb.hspan(y, xa, xb);
             }
         }
     }
+};
+
+// Function to clip a polygon using the Sutherland-Hodgman algorithm
+void clipPolygon() {
+    clippedPolygon.clear();
+    if (polygon.vertices.size() < 3) return; // Need at least a triangle
     
-    // If we have at least 3 points, we can form a polygon
-    if (clipPoints.size() >= 3) {
-        for (const auto& p : clipPoints) {
-            clippedPolygon.addVertex(p.x, p.y);
-        }
+    polygonClipper.setRect(clipRect);
+    polygonClipper.clip(polygon.vertices.size(),
+        [](size_t i) {
+            const Point& p = polygon.vertices[i];
+            return ClipVertex{ (double)p.x, (double)p.y };
+        },
+        [](double x, double y) {
+            clippedPolygon.addVertex((int)std::lround(x), (int)std::lround(y));
+        });
+    
+    // Fully outside, or squashed onto a boundary
+    if (clippedPolygon.vertices.size() < 3) {
+        clippedPolygon.clear();
     }
 }
 
@@ -203,16 +954,250 @@ void drawLine(const Line& line) {
     glEnd();
 }
 
+// Rectangle clipper for a polygon whose clip rectangle keeps moving, as
+// while it is dragged. It relies on clipping against a rectangle being
+// the same as clamping every point of the outline onto the rectangle:
+// the clamped outline winds around each interior point exactly as the
+// original does. Clamped runs of outside vertices lie along one side
+// (or collapse onto a corner) and add no area, so the output is just the
+// inside vertices plus the clamped points where edges cross the lines
+// x = xmin, x = xmax, y = ymin, y = ymax.
+//
+// Which of those an edge contributes depends only on the region codes of
+// its two ends. The codes are kept per vertex, and when the rectangle
+// moves only vertices in the strips swept by its sides can change code;
+// vertices sorted by x and by y find them with a binary search. The
+// contributing vertices and edges are indexed too: the runs of inside
+// vertices and the edges whose ends have different codes. moveRect
+// updates both for the reclassified vertices, and gather walks only them,
+// so a step costs O(reclassified log n + output) rather than O(n). The
+// crossing points themselves are recomputed on every gather, because
+// they slide with the rectangle.
+class IncrementalRectClipper {
+public:
+    IncrementalRectClipper() : rect(0, 0, 0, 0) {}
+
+    // Full setup: O(n log n)
+    void setPolygon(const std::vector<Point>& vertices, const ClippingRect& clip) {
+        size_t n = vertices.size();
+        xs.resize(n);
+        ys.resize(n);
+        codes.resize(n);
+        byX.resize(n);
+        byY.resize(n);
+        rect = clip;
+        for (size_t i = 0; i < n; i++) {
+            xs[i] = vertices[i].x;
+            ys[i] = vertices[i].y;
+            codes[i] = (uint8_t)computeRegionCode(xs[i], ys[i], rect);
+            byX[i] = byY[i] = (int)i;
+        }
+        std::sort(byX.begin(), byX.end(), [&](int a, int b) { return xs[a] < xs[b]; });
+        std::sort(byY.begin(), byY.end(), [&](int a, int b) { return ys[a] < ys[b]; });
+        insideRuns.clear();
+        crossingEdges.clear();
+        for (size_t i = 0; i < n; i++) {
+            if (codes[i] == 0) {
+                size_t end = i;
+                while (end + 1 < n && codes[end + 1] == 0) end++;
+                insideRuns[(int)i] = (int)end;
+                i = end;
+            }
+        }
+        for (size_t i = 0; i < n; i++) updateEdge(i);
+    }
+
+    // Moves the rectangle and updates the codes of the vertices whose
+    // region changed. Returns how many vertices were reclassified.
+    size_t moveRect(const ClippingRect& clip) {
+        ClippingRect old = rect;
+        rect = clip;
+        size_t touched = 0;
+        touched += reclassify(byX, xs, old.xmin, rect.xmin);
+        touched += reclassify(byX, xs, old.xmax, rect.xmax);
+        touched += reclassify(byY, ys, old.ymin, rect.ymin);
+        touched += reclassify(byY, ys, old.ymax, rect.ymax);
+        return touched;
+    }
+
+    // Calls emit(x, y) for each vertex of the clipped outline, in polygon
+    // order: vertex i if it is inside, then the crossings of edge i. Only
+    // the last vertex of an inside run can start a crossing edge.
+    template <typename Emit>
+    void gather(Emit emit) const {
+        auto run = insideRuns.begin();
+        auto edge = crossingEdges.begin();
+        while (run != insideRuns.end() || edge != crossingEdges.end()) {
+            if (run != insideRuns.end() && (edge == crossingEdges.end() || run->first <= *edge)) {
+                for (int i = run->first; i <= run->second; i++) emit((double)xs[i], (double)ys[i]);
+                if (edge != crossingEdges.end() && *edge == run->second) emitEdge(*edge++, emit);
+                ++run;
+            } else {
+                emitEdge(*edge++, emit);
+            }
+        }
+    }
+
+private:
+    std::vector<int> xs, ys;
+    std::vector<uint8_t> codes;
+    std::vector<int> byX, byY;
+    ClippingRect rect;
+    std::map<int, int> insideRuns;  // first -> last index of each run of inside vertices
+    std::set<int> crossingEdges;    // edges i -> i + 1 whose ends differ in code
+
+    size_t nextIndex(size_t i) const { return i + 1 == xs.size() ? 0 : i + 1; }
+
+    template <typename Emit>
+    void emitEdge(int i, Emit& emit) const {
+        size_t j = nextIndex(i);
+        emitCrossings(i, j, codes[i] ^ codes[j], emit);
+    }
+
+    void updateEdge(size_t i) {
+        if (codes[i] != codes[nextIndex(i)]) crossingEdges.insert((int)i);
+        else crossingEdges.erase((int)i);
+    }
+
+    // Vertex v has just become inside: join it to the runs on either side
+    void addInside(int v) {
+        int last = v;
+        auto after = insideRuns.find(v + 1);
+        if (after != insideRuns.end()) {
+            last = after->second;
+            insideRuns.erase(after);
+        }
+        auto before = insideRuns.lower_bound(v);
+        if (before != insideRuns.begin() && std::prev(before)->second == v - 1) {
+            std::prev(before)->second = last;
+            return;
+        }
+        insideRuns[v] = last;
+    }
+
+    // Vertex v has just left the inside: split its run around it
+    void removeInside(int v) {
+        auto run = std::prev(insideRuns.upper_bound(v));
+        int first = run->first, last = run->second;
+        insideRuns.erase(run);
+        if (first < v) insideRuns[first] = v - 1;
+        if (v < last) insideRuns[v + 1] = last;
+    }
+
+    // Recomputes the codes of the vertices whose coordinate lies between
+    // the old and new position of one side
+    size_t reclassify(const std::vector<int>& sorted, const std::vector<int>& coord, int from, int to) {
+        if (from == to) return 0;
+        int lo = std::min(from, to), hi = std::max(from, to);
+        auto first = std::lower_bound(sorted.begin(), sorted.end(), lo,
+                                      [&](int v, int value) { return coord[v] < value; });
+        auto last = std::upper_bound(sorted.begin(), sorted.end(), hi,
+                                     [&](int value, int v) { return value < coord[v]; });
+        for (auto it = first; it != last; ++it) {
+            int v = *it;
+            uint8_t code = (uint8_t)computeRegionCode(xs[v], ys[v], rect);
+            if (code == codes[v]) continue;
+            if (codes[v] == 0) removeInside(v);
+            else if (code == 0) addInside(v);
+            codes[v] = code;
+            updateEdge(v);
+            updateEdge(v == 0 ? xs.size() - 1 : v - 1);
+        }
+        return last - first;
+    }
+
+    // Clamped crossings of edge i -> j with the lines in `crossed`, in order
+    // along the edge
+    template <typename Emit>
+    void emitCrossings(size_t i, size_t j, int crossed, Emit& emit) const {
+        double x0 = xs[i], y0 = ys[i], dx = xs[j] - x0, dy = ys[j] - y0;
+        double t[4];
+        int line[4], count = 0;
+        const int lines[4] = { LEFT, RIGHT, BOTTOM, TOP };
+        const int bound[4] = { rect.xmin, rect.xmax, rect.ymin, rect.ymax };
+        for (int k = 0; k < 4; k++) {
+            if (!(crossed & lines[k])) continue;
+            double value = k < 2 ? (bound[k] - x0) / dx : (bound[k] - y0) / dy;
+            int at = count++;
+            for (; at > 0 && t[at - 1] > value; at--) {
+                t[at] = t[at - 1];
+                line[at] = line[at - 1];
+            }
+            t[at] = value;
+            line[at] = k;
+        }
+        for (int c = 0; c < count; c++) {
+            double x = x0 + t[c] * dx, y = y0 + t[c] * dy;
+            if (line[c] < 2) x = bound[line[c]];
+            else y = bound[line[c]];
+            emit(std::min(std::max(x, (double)rect.xmin), (double)rect.xmax),
+                 std::min(std::max(y, (double)rect.ymin), (double)rect.ymax));
+        }
+    }
+};
+
+IncrementalRectClipper dragClipper;
+
+// Rebuild clippedPolygon from dragClipper, dropping repeated points
+void gatherDragClip() {
+    clippedPolygon.clear();
+    dragClipper.gather([](double x, double y) {
+        Point p((int)std::lround(x), (int)std::lround(y));
+        if (clippedPolygon.vertices.empty() || !(clippedPolygon.vertices.back() == p)) {
+            clippedPolygon.vertices.push_back(p);
+        }
+    });
+    std::vector<Point>& vertices = clippedPolygon.vertices;
+    if (vertices.size() > 1 && vertices.back() == vertices.front()) vertices.pop_back();
+    if (vertices.size() < 3) clippedPolygon.clear();
+}
+
+// Fill a polygon in software over the current viewport and draw the
+// result with glDrawPixels. Like the rest of this file it assumes the
+// projection maps world units 1:1 onto viewport pixels. Unfilled pixels
+// get alpha 0 and are dropped by the alpha test, so whatever the viewport
+// already shows stays visible.
+void fillPolygonScanline(const MyPolygon& poly, FillRule rule = FILL_EVEN_ODD) {
+    static ScanlineFiller filler;
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    static Framebuffer framebuffer(0, 0);
+    static PolygonSoA contour;
+    
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    if (framebuffer.width != viewport[2] || framebuffer.height != viewport[3]) {
+        framebuffer = Framebuffer(viewport[2], viewport[3]);
+    }
+    framebuffer.originX = viewport[0];
+    framebuffer.originY = viewport[1];
+    GLfloat color[4];
+    glGetFloatv(GL_CURRENT_COLOR, color);
+    framebuffer.setColor(color[0], color[1], color[2]);
+    framebuffer.color |= 0xFF000000;
+    framebuffer.clear();
+    
+    contour.x.clear();
+    contour.y.clear();
+    for (const auto& vertex : poly.vertices) {
+        contour.x.push_back(vertex.x);
+        contour.y.push_back(vertex.y);
+    }
+    contour.offsets.assign({ 0, (int)contour.x.size() });
+    filler.fill(contour, rule, framebuffer, &pool);
+    
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GREATER, 0.0f);
+    glRasterPos2i(viewport[0], viewport[1]);
+    glDrawPixels(framebuffer.width, framebuffer.height, GL_BGRA, GL_UNSIGNED_BYTE, framebuffer.pixels.data());
+    glDisable(GL_ALPHA_TEST);
+}
+
 // Draw a polygon
 void drawPolygon(const MyPolygon& poly, bool filled = false) {
     if (poly.vertices.empty()) return;
     
     if (filled) {
-        glBegin(GL_POLYGON);
-        for (const auto& vertex : poly.vertices) {
-            glVertex2i(vertex.x, vertex.y);
-        }
-        glEnd();
+        fillPolygonScanline(poly);
     } else {
         glBegin(GL_LINE_LOOP);
         for (const auto& vertex : poly.vertices) {
@@ -237,16 +1222,59 @@ void drawClippingRect() {
     glEnd();
 }
 
-// Map coordinates from original space to viewport space
-Point mapToViewport(const Point& p) {
-    float xRatio = (float)(p.x - clipRect.xmin) / (clipRect.xmax - clipRect.xmin);
-    float yRatio = (float)(p.y - clipRect.ymin) / (clipRect.ymax - clipRect.ymin);
+// Window-to-viewport mapping as one affine transform per axis:
+// view = world * scale + offset
+struct ViewportMapping {
+    double scaleX, scaleY, offsetX, offsetY;
     
-    int viewX = VIEWPORT_X + xRatio * VIEWPORT_WIDTH;
-    int viewY = VIEWPORT_Y + yRatio * VIEWPORT_HEIGHT;
+    explicit ViewportMapping(const ClippingRect& rect) {
+        scaleX = (double)VIEWPORT_WIDTH / (rect.xmax - rect.xmin);
+        scaleY = (double)VIEWPORT_HEIGHT / (rect.ymax - rect.ymin);
+        offsetX = VIEWPORT_X - rect.xmin * scaleX;
+        offsetY = VIEWPORT_Y - rect.ymin * scaleY;
+    }
     
-    return Point(viewX, viewY);
-}
+    void apply(const MyPolygon& in, MyPolygon& out) const {
+        out.vertices.clear();
+        out.vertices.reserve(in.vertices.size());
+        for (const Point& p : in.vertices) {
+            out.vertices.push_back(Point((int)(p.x * scaleX + offsetX), (int)(p.y * scaleY + offsetY)));
+        }
+        out.version++;
+    }
+};
+
+// Clip result and its viewport coordinates, rebuilt only when the polygon,
+// its closed state or the clip rectangle changed since the last frame. A
+// rectangle-only change (dragging) is clipped incrementally.
+struct ViewportCache {
+    unsigned polygonVersion = ~0u, rectVersion = ~0u;
+    bool closed = false;
+    MyPolygon viewportPolygon;
+    
+    const MyPolygon& update() {
+        if (polygon.version == polygonVersion && clipRectVersion == rectVersion && polygonClosed == closed) {
+            return viewportPolygon;
+        }
+        if (!polygonClosed) {
+            clippedPolygon.clear();
+        } else {
+            if (polygon.version != polygonVersion || !closed) {
+                dragClipper.setPolygon(polygon.vertices, clipRect);
+            } else {
+                dragClipper.moveRect(clipRect);
+            }
+            gatherDragClip();
+        }
+        ViewportMapping(clipRect).apply(clippedPolygon, viewportPolygon);
+        polygonVersion = polygon.version;
+        rectVersion = clipRectVersion;
+        closed = polygonClosed;
+        return viewportPolygon;
+    }
+};
+
+ViewportCache viewportCache;
 
 // Display callback function
 void display() {
@@ -274,12 +1302,8 @@ void display() {
     
     // Draw the clipped polygon in the viewport
     glColor3f(0.0f, 1.0f, 0.0f); // Green
-    if (!clippedPolygon.vertices.empty()) {
-        MyPolygon viewportPolygon;
-        for (const auto& vertex : clippedPolygon.vertices) {
-            Point viewportPoint = mapToViewport(vertex);
-            viewportPolygon.addVertex(viewportPoint.x, viewportPoint.y);
-        }
+    const MyPolygon& viewportPolygon = viewportCache.update();
+    if (!viewportPolygon.vertices.empty()) {
         drawPolygon(viewportPolygon, true);
     }
     
@@ -295,6 +1319,49 @@ void reshape(int width, int height) {
     glMatrixMode(GL_MODELVIEW);
 }
 
+// Mouse callback function: build the polygon on the left side, then drag
+// the clipping rectangle around
+void mouse(int button, int state, int x, int y) {
+    // Adjust y coordinate (OpenGL origin is at bottom-left)
+    y = WINDOW_HEIGHT - y;
+    
+    if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN) {
+        if (!polygonClosed) {
+            if (x < VIEWPORT_X) {
+                polygon.addVertex(x, y);
+                drawingPolygon = true;
+            }
+        } else if (x >= clipRect.xmin && x <= clipRect.xmax && y >= clipRect.ymin && y <= clipRect.ymax) {
+            draggingRect = true;
+            dragX = x;
+            dragY = y;
+        }
+    } else if (button == GLUT_LEFT_BUTTON && state == GLUT_UP) {
+        draggingRect = false;
+    } else if (button == GLUT_RIGHT_BUTTON && state == GLUT_DOWN) {
+        // Close the polygon
+        if (drawingPolygon && polygon.vertices.size() >= 3) {
+            drawingPolygon = false;
+            polygonClosed = true;
+        }
+    }
+    glutPostRedisplay();
+}
+
+// Motion callback function
+void motion(int x, int y) {
+    // Adjust y coordinate (OpenGL origin is at bottom-left)
+    y = WINDOW_HEIGHT - y;
+    
+    if (draggingRect && (x != dragX || y != dragY)) {
+        int dx = x - dragX, dy = y - dragY;
+        setClipRect(ClippingRect(clipRect.xmin + dx, clipRect.ymin + dy, clipRect.xmax + dx, clipRect.ymax + dy));
+        dragX = x;
+        dragY = y;
+        glutPostRedisplay();
+    }
+}
+
 // Keyboard callback function
 void keyboard(unsigned char key, int x, int y) {
     if (key == 27) { // ESC key
@@ -302,16 +1369,13 @@ void keyboard(unsigned char key, int x, int y) {
     } else if (key == 'c' || key == 'C') {
         // Clear the polygon
         polygon.clear();
-        clippedPolygon.clear();
         drawingPolygon = false;
         polygonClosed = false;
+        draggingRect = false;
         glutPostRedisplay();
     } else if (key == 'r' || key == 'R') {
         // Reset the clipping rectangle
-        clipRect = ClippingRect(100, 100, 300, 500);
-        if (polygonClosed) {
-            clipPolygon();
-        }
+        setClipRect(ClippingRect(100, 100, 300, 500));
         glutPostRedisplay();
     }
 }
@@ -323,7 +1387,326 @@ void init() {
     glLineWidth(2.0f);
 }
 
+// Headless mode: ./output --bench measures the clipper without a window
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Random star-shaped polygons with 8..64 vertices scattered around the
+// clip rectangle
+void makeRandomPolygons(int count, unsigned seed, PolygonSoA& polygons) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> center(0, 400), radius(10, 150), unit(0, 1);
+    std::uniform_int_distribution<int> vertices(8, 64);
+    std::vector<double>& xs = polygons.x;
+    std::vector<double>& ys = polygons.y;
+    std::vector<int>& offsets = polygons.offsets;
+    xs.clear();
+    ys.clear();
+    offsets.assign(1, 0);
+    for (int p = 0; p < count; p++) {
+        double cx = center(rng), cy = center(rng) + 100, r = radius(rng);
+        int n = vertices(rng);
+        for (int i = 0; i < n; i++) {
+            double angle = 2 * M_PI * i / n, d = r * (0.3 + 0.7 * unit(rng));
+            xs.push_back(cx + d * cos(angle));
+            ys.push_back(cy + d * sin(angle));
+        }
+        offsets.push_back((int)xs.size());
+    }
+}
+
+int runBenchmark() {
+    int failures = 0;
+
+    // A polygon enclosing the whole rectangle must come back as its corners
+    ClippingRect rect(100, 100, 300, 500);
+    PolygonClipper clipper(rect);
+    const ClipVertex around[] = { {-200, 300}, {200, -300}, {600, 300}, {200, 900} };
+    std::vector<ClipVertex> out;
+    clipper.clip(4, [&](size_t i) { return around[i]; },
+                 [&](double x, double y) { out.push_back(ClipVertex{ x, y }); });
+    printf("enclosing diamond ->");
+    for (const ClipVertex& v : out) printf(" (%g, %g)", v.x, v.y);
+    printf("\n");
+
+    const int POLYGONS = 200000;
+    PolygonSoA polygons;
+    makeRandomPolygons(POLYGONS, 1, polygons);
+    const std::vector<double>& xs = polygons.x;
+    const std::vector<double>& ys = polygons.y;
+    const std::vector<int>& offsets = polygons.offsets;
+
+    // Output goes to one reused buffer; its capacity settles after the
+    // first pass, so the timed passes do not touch the heap
+    std::vector<ClipVertex> output;
+    size_t produced = 0;
+    auto clipAll = [&]() {
+        produced = 0;
+        for (int p = 0; p < POLYGONS; p++) {
+            const double* px = xs.data() + offsets[p];
+            const double* py = ys.data() + offsets[p];
+            output.clear();
+            clipper.clip(offsets[p + 1] - offsets[p],
+                         [&](size_t i) { return ClipVertex{ px[i], py[i] }; },
+                         [&](double x, double y) { output.push_back(ClipVertex{ x, y }); });
+            produced += output.size();
+        }
+    };
+    clipAll();
+    const int PASSES = 5;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASSES; pass++) clipAll();
+    double seconds = secondsSince(start) / PASSES;
+    printf("%d polygons, %zu vertices in, %zu out: %.1f M vertices/s, %.1f ns/polygon\n", POLYGONS,
+           xs.size(), produced, xs.size() / seconds / 1e6, seconds / POLYGONS * 1e9);
+
+    // Batch engine: thread scaling, checked against the serial clipper
+    PolygonSoA serial, batch;
+    {
+        ThreadPool pool(1);
+        BatchPolygonClipper(pool).clip(polygons, rect, serial);
+    }
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double oneThread = 0;
+    for (int threads = 1; threads <= maxThreads; threads = (threads == maxThreads) ? threads + 1
+                                                             : std::min(threads * 2, maxThreads)) {
+        ThreadPool pool(threads);
+        BatchPolygonClipper engine(pool);
+        engine.clip(polygons, rect, batch);
+        start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < PASSES; pass++) engine.clip(polygons, rect, batch);
+        seconds = secondsSince(start) / PASSES;
+        if (threads == 1) oneThread = seconds;
+        bool same = batch.offsets == serial.offsets && batch.x == serial.x && batch.y == serial.y;
+        printf("batch, %d thread(s): %.1f M vertices/s, speedup %.2fx, %s\n", threads,
+               xs.size() / seconds / 1e6, oneThread / seconds, same ? "matches serial" : "MISMATCH");
+        failures += !same;
+    }
+
+    // Line clipping: clipLine one line at a time versus the batch clipper
+    const int LINES = 1000000;
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int> lineX(0, WINDOW_WIDTH), lineY(0, WINDOW_HEIGHT);
+    LineSoA lines, clippedLines;
+    lines.resize(LINES);
+    for (int i = 0; i < LINES; i++) {
+        lines.x0[i] = lineX(rng);
+        lines.y0[i] = lineY(rng);
+        lines.x1[i] = lineX(rng);
+        lines.y1[i] = lineY(rng);
+    }
+    std::vector<Line> scalarOut;
+    std::vector<int> scalarSource, batchSource;
+    scalarOut.reserve(LINES);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LINES; i++) {
+        Line line(Point(lines.x0[i], lines.y0[i]), Point(lines.x1[i], lines.y1[i]));
+        Line clipped(Point(0, 0), Point(0, 0));
+        if (clipLine(line, rect, clipped)) {
+            scalarOut.push_back(clipped);
+            scalarSource.push_back(i);
+        }
+    }
+    double scalar = secondsSince(start);
+    BatchLineClipper lineClipper;
+    lineClipper.clip(lines, rect, clippedLines, batchSource);
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASSES; pass++) lineClipper.clip(lines, rect, clippedLines, batchSource);
+    double batched = secondsSince(start) / PASSES;
+    // Must keep the same lines as clipLine, with endpoints at most 1 px apart
+    int onlyScalar = 0, onlyBatch = 0, onePixel = 0, farther = 0;
+    for (size_t a = 0, b = 0; a < scalarSource.size() || b < batchSource.size();) {
+        if (b == batchSource.size() || (a < scalarSource.size() && scalarSource[a] < batchSource[b])) {
+            onlyScalar++;
+            a++;
+        } else if (a == scalarSource.size() || batchSource[b] < scalarSource[a]) {
+            onlyBatch++;
+            b++;
+        } else {
+            int d = std::max(std::max(std::abs(scalarOut[a].start.x - clippedLines.x0[b]),
+                                      std::abs(scalarOut[a].start.y - clippedLines.y0[b])),
+                             std::max(std::abs(scalarOut[a].end.x - clippedLines.x1[b]),
+                                      std::abs(scalarOut[a].end.y - clippedLines.y1[b])));
+            onePixel += d == 1;
+            farther += d > 1;
+            a++;
+            b++;
+        }
+    }
+    printf("%d lines: clipLine %.1f M lines/s, batch %.1f M lines/s\n", LINES, LINES / scalar / 1e6,
+           LINES / batched / 1e6);
+    bool linesOk = onlyScalar == 0 && onlyBatch == 0 && farther == 0;
+    printf("  %zu vs %zu visible: %d only clipLine, %d only batch, %d lines 1 px apart, "
+           "%d more than 1 px apart: %s\n", scalarOut.size(), clippedLines.size(), onlyScalar,
+           onlyBatch, onePixel, farther, linesOk ? "within tolerance" : "FAILED");
+    failures += !linesOk;
+
+    // General windows: 10k-vertex wavy polygons against a rotated square
+    // (Cyrus-Beck/Sutherland-Hodgman and Greiner-Hormann must agree) and
+    // against each other
+    auto flower = [](int n, double cx, double cy, int petals, double phase) {
+        std::vector<ClipVertex> poly;
+        for (int i = 0; i < n; i++) {
+            double angle = 2 * M_PI * i / n, r = 100 * (1 + 0.3 * sin(petals * angle + phase));
+            poly.push_back(ClipVertex{ cx + r * cos(angle), cy + r * sin(angle) });
+        }
+        return poly;
+    };
+    auto totalArea = [](const PolygonSoA& pieces) {
+        double area = 0;
+        std::vector<ClipVertex> piece;
+        for (int k = 0; k < pieces.count(); k++) {
+            piece.clear();
+            for (int i = pieces.offsets[k]; i < pieces.offsets[k + 1]; i++) {
+                piece.push_back(ClipVertex{ pieces.x[i], pieces.y[i] });
+            }
+            area += std::fabs(signedArea2(piece)) / 2;
+        }
+        return area;
+    };
+    const int BIG = 10000;
+    std::vector<ClipVertex> subject = flower(BIG, 0, 0, 9, 0), window = flower(BIG, 30, 10, 7, 1);
+    std::vector<ClipVertex> rotated, convexOut;
+    for (int k = 0; k < 4; k++) {
+        double angle = 0.3 + k * M_PI / 2;
+        rotated.push_back(ClipVertex{ 10 + 80 * cos(angle), -5 + 80 * sin(angle) });
+    }
+    ConvexClipWindow convex(rotated);
+    GreinerHormannClipper general;
+    PolygonSoA pieces;
+    const int REPEATS = 20;
+    convex.clipPolygon(subject, convexOut);
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; r++) convex.clipPolygon(subject, convexOut);
+    double convexTime = secondsSince(start) / REPEATS;
+    general.intersect(subject, rotated, pieces);
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; r++) general.intersect(subject, rotated, pieces);
+    double generalTime = secondsSince(start) / REPEATS;
+    printf("%d vertices vs rotated square: convex %.3f ms (area %.3f), Greiner-Hormann %.3f ms (area %.3f)\n",
+           BIG, convexTime * 1e3, std::fabs(signedArea2(convexOut)) / 2, generalTime * 1e3, totalArea(pieces));
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; r++) general.intersect(subject, window, pieces);
+    generalTime = secondsSince(start) / REPEATS;
+    printf("%d vs %d vertices, concave: Greiner-Hormann %.3f ms, %d pieces, area %.1f, "
+           "%zu of %.0f edge pairs tested\n", BIG, BIG, generalTime * 1e3, pieces.count(), totalArea(pieces),
+           general.pairsTested, (double)BIG * BIG);
+
+    // Scanline fill: a pentagram differs between the rules in its middle,
+    // then a large concave polygon on 1..N threads
+    PolygonSoA star;
+    for (int k = 0; k < 5; k++) {
+        double angle = M_PI / 2 + k * 4 * M_PI / 5;
+        star.x.push_back(50 + 40 * cos(angle));
+        star.y.push_back(50 + 40 * sin(angle));
+    }
+    star.offsets.assign({ 0, 5 });
+    Framebuffer small(100, 100);
+    ScanlineFiller filler;
+    filler.fill(star, FILL_EVEN_ODD, small);
+    bool evenOddHole = small.at(50, 50) == 0;
+    small.clear();
+    filler.fill(star, FILL_NONZERO, small);
+    printf("pentagram center: even-odd %s, nonzero %s\n", evenOddHole ? "empty" : "filled",
+           small.at(50, 50) ? "filled" : "empty");
+
+    const int FILL_SIZE = 2048;
+    PolygonSoA wavy;
+    for (const ClipVertex& v : flower(BIG, 0, 0, 11, 0)) {
+        wavy.x.push_back(FILL_SIZE / 2 + v.x * FILL_SIZE / 300);
+        wavy.y.push_back(FILL_SIZE / 2 + v.y * FILL_SIZE / 300);
+    }
+    wavy.offsets.assign({ 0, BIG });
+    Framebuffer serialFill(FILL_SIZE, FILL_SIZE), threadedFill(FILL_SIZE, FILL_SIZE);
+    filler.fill(wavy, FILL_NONZERO, serialFill);
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < REPEATS; r++) filler.fill(wavy, FILL_NONZERO, serialFill);
+    double fillTime = secondsSince(start) / REPEATS;
+    size_t covered = std::count(serialFill.pixels.begin(), serialFill.pixels.end(), serialFill.color);
+    printf("%dx%d fill of a %d-vertex polygon: %.3f ms, %.1f M pixels/s\n", FILL_SIZE, FILL_SIZE, BIG,
+           fillTime * 1e3, covered / fillTime / 1e6);
+    for (int threads = 1; threads <= maxThreads; threads = (threads == maxThreads) ? threads + 1
+                                                             : std::min(threads * 2, maxThreads)) {
+        ThreadPool pool(threads);
+        threadedFill.clear();
+        filler.fill(wavy, FILL_NONZERO, threadedFill, &pool);
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < REPEATS; r++) filler.fill(wavy, FILL_NONZERO, threadedFill, &pool);
+        double seconds = secondsSince(start) / REPEATS;
+        printf("  %d thread(s): %.3f ms, speedup %.2fx, %s\n", threads, seconds * 1e3, fillTime / seconds,
+               threadedFill.pixels == serialFill.pixels ? "matches serial" : "MISMATCH");
+        failures += threadedFill.pixels != serialFill.pixels;
+    }
+
+    // Viewport cache: frames where nothing changed versus frames where the
+    // polygon was touched, on a 100k-vertex polygon
+    const int HUGE_POLYGON = 100000, FRAMES = 100;
+    polygon.clear();
+    for (const ClipVertex& v : flower(HUGE_POLYGON, 200, 300, 13, 0)) {
+        polygon.addVertex((int)std::lround(v.x), (int)std::lround(v.y));
+    }
+    polygonClosed = true;
+    viewportCache.update();
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++) viewportCache.update();
+    double hit = secondsSince(start) / FRAMES;
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++) {
+        polygon.version++;
+        viewportCache.update();
+    }
+    double miss = secondsSince(start) / FRAMES;
+    printf("%d-vertex polygon: clip + map %.3f ms/frame, cached %.3f us/frame, %zu viewport vertices\n",
+           HUGE_POLYGON, miss * 1e3, hit * 1e6, viewportCache.viewportPolygon.vertices.size());
+
+    // Dragging: the rectangle moves a few pixels per frame across the
+    // polygon. Each step is clipped incrementally and from scratch with
+    // the streaming clipper; both results are filled and compared.
+    const int STEPS = 200;
+    Framebuffer fullFill(WINDOW_WIDTH, WINDOW_HEIGHT), dragFill(WINDOW_WIDTH, WINDOW_HEIGHT);
+    PolygonSoA fullContour, dragContour;
+    auto toContour = [](const MyPolygon& poly, PolygonSoA& contour) {
+        contour.x.clear();
+        contour.y.clear();
+        for (const Point& v : poly.vertices) {
+            contour.x.push_back(v.x);
+            contour.y.push_back(v.y);
+        }
+        contour.offsets.assign({ 0, (int)contour.x.size() });
+    };
+    setClipRect(ClippingRect(0, 100, 200, 500));
+    dragClipper.setPolygon(polygon.vertices, clipRect);
+    double fullTime = 0, dragTime = 0;
+    size_t reclassified = 0, pixelMismatches = 0;
+    for (int step = 0; step < STEPS; step++) {
+        setClipRect(ClippingRect(clipRect.xmin + 1, clipRect.ymin + (step % 7) - 3,
+                                 clipRect.xmax + 1, clipRect.ymax + (step % 7) - 3));
+        start = std::chrono::steady_clock::now();
+        clipPolygon();
+        fullTime += secondsSince(start);
+        toContour(clippedPolygon, fullContour);
+        start = std::chrono::steady_clock::now();
+        reclassified += dragClipper.moveRect(clipRect);
+        gatherDragClip();
+        dragTime += secondsSince(start);
+        toContour(clippedPolygon, dragContour);
+        fullFill.clear();
+        dragFill.clear();
+        filler.fill(fullContour, FILL_EVEN_ODD, fullFill);
+        filler.fill(dragContour, FILL_EVEN_ODD, dragFill);
+        for (size_t k = 0; k < fullFill.pixels.size(); k++) pixelMismatches += fullFill.pixels[k] != dragFill.pixels[k];
+    }
+    printf("drag over %d vertices: full re-clip %.3f ms/step, incremental %.3f ms/step "
+           "(%.0f vertices reclassified/step), %zu pixels differ over %d steps\n", HUGE_POLYGON,
+           fullTime / STEPS * 1e3, dragTime / STEPS * 1e3, (double)reclassified / STEPS, pixelMismatches, STEPS);
+    failures += pixelMismatches != 0;
+    return failures ? 1 : 0;
+}
+
 int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) return runBenchmark();
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
@@ -334,11 +1717,16 @@ int main(int argc, char** argv) {
     glutDisplayFunc(display);
     glutReshapeFunc(reshape);
     glutKeyboardFunc(keyboard);
+    glutMouseFunc(mouse);
+    glutMotionFunc(motion);
     
     init();
     
-    std::cout << "Polygon Clipping with Viewport Demo (Static Polygon)" << std::endl;
+    std::cout << "Polygon Clipping with Viewport Demo" << std::endl;
+    std::cout << "Left-click on the left side to add vertices, right-click to close the polygon" << std::endl;
+    std::cout << "Then drag the clipping rectangle with the left button" << std::endl;
     std::cout << "The original and clipped polygons are shown." << std::endl;
+    std::cout << "Press 'C' to clear the polygon" << std::endl;
     std::cout << "Press 'R' to reset the clipping rectangle" << std::endl;
     std::cout << "Press 'ESC' to exit" << std::endl;
     
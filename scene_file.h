@@ -0,0 +1,183 @@
+#ifndef SCENE_FILE_H
+#define SCENE_FILE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Fixed-record binary shape list, mapped straight into memory. A 32-byte
+// header is followed by one int32 array per field (SoA), each `capacity`
+// records long, so field f of record i lives at
+//     header + (f * capacity + i) * 4
+// Opening a file is a single mmap: nothing is parsed. Records are appended
+// in place; when the file is full it is grown to twice the capacity and
+// the arrays are moved to their new offsets.
+struct SceneHeader {
+    char magic[4];          // "SCNE"
+    uint32_t version;
+    uint32_t fields;        // int32 values per record
+    uint32_t count;         // records in use
+    uint32_t capacity;      // records the arrays have room for
+    uint32_t reserved[3];
+};
+
+class SceneFile {
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t INITIAL_CAPACITY = 1024;
+
+    SceneFile() = default;
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+    ~SceneFile() { close(); }
+
+    // Opens path, creating an empty scene if it does not exist. Fails on
+    // an unreadable file or one written with another record layout.
+    bool open(const char* path, uint32_t fields) {
+        close();
+        fd = ::open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            perror(path);
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            perror(path);
+            close();
+            return false;
+        }
+        if (st.st_size == 0) {
+            if (!resize(fields, INITIAL_CAPACITY)) {
+                close();
+                return false;
+            }
+            memcpy(header->magic, "SCNE", 4);
+            header->version = VERSION;
+            header->fields = fields;
+            header->count = 0;
+            header->capacity = INITIAL_CAPACITY;
+            return true;
+        }
+        if ((size_t)st.st_size < sizeof(SceneHeader) || !map((size_t)st.st_size)) {
+            fprintf(stderr, "%s: not a scene file\n", path);
+            close();
+            return false;
+        }
+        if (memcmp(header->magic, "SCNE", 4) != 0 || header->version != VERSION ||
+            header->fields != fields || header->capacity == 0 || header->count > header->capacity ||
+            mappedBytes < bytesFor(fields, header->capacity)) {
+            fprintf(stderr, "%s: not a scene file with %u fields per record\n", path, fields);
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (header) munmap(header, mappedBytes);
+        if (fd >= 0) ::close(fd);
+        header = nullptr;
+        mappedBytes = 0;
+        fd = -1;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+    uint32_t count() const { return header ? header->count : 0; }
+
+    // Array of field f, count() entries long
+    const int32_t* field(uint32_t f) const {
+        return data() + (size_t)f * header->capacity;
+    }
+
+    // Appends one record of header->fields values
+    bool append(const int32_t* values) {
+        if (!header || header->count == UINT32_MAX) return false;
+        if (header->count == header->capacity && !grow(doubledCapacity(header->count + 1))) return false;
+        int32_t* base = data();
+        for (uint32_t f = 0; f < header->fields; f++) {
+            base[(size_t)f * header->capacity + header->count] = values[f];
+        }
+        header->count++;
+        return true;
+    }
+
+    // Appends n records given as one array per field
+    bool appendBulk(const int32_t* const* columns, uint32_t n) {
+        if (!header) return false;
+        if ((size_t)header->count + n > UINT32_MAX) return false;
+        uint32_t needed = header->count + n;
+        if (needed > header->capacity && !grow(doubledCapacity(needed))) return false;
+        for (uint32_t f = 0; f < header->fields; f++) {
+            memcpy(data() + (size_t)f * header->capacity + header->count, columns[f], n * sizeof(int32_t));
+        }
+        header->count = needed;
+        return true;
+    }
+
+    // Drops all records; the file keeps its capacity
+    void clear() {
+        if (header) header->count = 0;
+    }
+
+private:
+    int fd = -1;
+    SceneHeader* header = nullptr;
+    size_t mappedBytes = 0;
+
+    static size_t bytesFor(uint32_t fields, uint32_t capacity) {
+        return sizeof(SceneHeader) + (size_t)fields * capacity * sizeof(int32_t);
+    }
+
+    int32_t* data() const { return (int32_t*)(header + 1); }
+
+    // Current capacity doubled until it holds needed records, capped at
+    // UINT32_MAX so the count can never wrap
+    uint32_t doubledCapacity(size_t needed) const {
+        size_t capacity = header->capacity;
+        while (capacity < needed) capacity *= 2;
+        return (uint32_t)std::min(capacity, (size_t)UINT32_MAX);
+    }
+
+    bool map(size_t bytes) {
+        void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            perror("mmap");
+            return false;
+        }
+        header = (SceneHeader*)p;
+        mappedBytes = bytes;
+        return true;
+    }
+
+    // Sizes the file for capacity records and maps all of it
+    bool resize(uint32_t fields, uint32_t capacity) {
+        if (header) munmap(header, mappedBytes);
+        header = nullptr;
+        size_t bytes = bytesFor(fields, capacity);
+        if (ftruncate(fd, (off_t)bytes) != 0) {
+            perror("ftruncate");
+            return false;
+        }
+        return map(bytes);
+    }
+
+    // Enlarges the arrays, moving them from the last field to the first
+    // so no array overwrites one that has not been moved yet
+    bool grow(uint32_t capacity) {
+        uint32_t fields = header->fields, oldCapacity = header->capacity, count = header->count;
+        if (!resize(fields, capacity)) return false;
+        for (uint32_t f = fields; f-- > 1;) {
+            memmove(data() + (size_t)f * capacity, data() + (size_t)f * oldCapacity,
+                    count * sizeof(int32_t));
+        }
+        header->capacity = capacity;
+        return true;
+    }
+};
+
+#endif
@@ -2,6 +2,14 @@
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <climits>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include "vertex_batch.h"
+#include "scene_file.h"
 
 // Window dimensions
 const int WINDOW_WIDTH = 800;
@@ -16,21 +24,189 @@ struct SquareArc {
         : centerX(cx), centerY(cy), size(s) {}
 };
 
+// Whether (x, y) lies on or inside the rounded outline of a square
+bool squareContains(const SquareArc& square, int x, int y) {
+    int halfSize = square.size / 2;
+    int cornerRadius = square.size / 4;
+    int dx = std::abs(x - square.centerX);
+    int dy = std::abs(y - square.centerY);
+    if (dx > halfSize || dy > halfSize) return false;
+    // Inside the corner box only the quarter disc belongs to the shape
+    int ex = dx - (halfSize - cornerRadius);
+    int ey = dy - (halfSize - cornerRadius);
+    if (ex > 0 && ey > 0) return ex * ex + ey * ey <= cornerRadius * cornerRadius;
+    return true;
+}
+
+// Uniform grid over the squares' bounding boxes. Cells are hashed, so
+// squares may lie anywhere, and each square is listed in every cell its
+// box touches. Point queries read one cell. Rectangle queries read the
+// covered cells and drop duplicates with a per-square query stamp.
+struct SquareGrid {
+    int cellSize;
+    std::unordered_map<long long, std::vector<int>> cells;
+    std::vector<unsigned> stamps;
+    unsigned queryStamp = 0;
+
+    explicit SquareGrid(int size) : cellSize(size) {}
+
+    static long long key(int cx, int cy) {
+        return (long long)(((unsigned long long)(unsigned)cx << 32) | (unsigned)cy);
+    }
+
+    int cellOf(int v) const {
+        return (v >= 0) ? v / cellSize : -((-v + cellSize - 1) / cellSize);
+    }
+
+    void insert(const SquareArc& square, int index) {
+        int halfSize = square.size / 2;
+        for (int cy = cellOf(square.centerY - halfSize); cy <= cellOf(square.centerY + halfSize); cy++) {
+            for (int cx = cellOf(square.centerX - halfSize); cx <= cellOf(square.centerX + halfSize); cx++) {
+                cells[key(cx, cy)].push_back(index);
+            }
+        }
+        if ((int)stamps.size() <= index) stamps.resize(index + 1, 0);
+    }
+
+    // Rebuilds the grid for all squares at once. Every cell list is
+    // allocated once at its final size, in a map sized before the first
+    // insertion, and lists come out in index order as with one insert per
+    // square. When the covered cells span a range not much larger than
+    // the square count, the lists are bucketed by counting sort over that
+    // range; otherwise the (cell, square) pairs are sorted.
+    void build(const std::vector<SquareArc>& all) {
+        cells.clear();
+        stamps.assign(all.size(), 0);
+        queryStamp = 0;
+        if (all.empty()) return;
+        long long minX = LLONG_MAX, minY = LLONG_MAX, maxX = LLONG_MIN, maxY = LLONG_MIN;
+        for (const SquareArc& square : all) {
+            int halfSize = square.size / 2;
+            minX = std::min(minX, (long long)cellOf(square.centerX - halfSize));
+            maxX = std::max(maxX, (long long)cellOf(square.centerX + halfSize));
+            minY = std::min(minY, (long long)cellOf(square.centerY - halfSize));
+            maxY = std::max(maxY, (long long)cellOf(square.centerY + halfSize));
+        }
+        long long columns = maxX - minX + 1, range = columns * (maxY - minY + 1);
+        auto forEachCell = [&](auto visit) {
+            for (size_t i = 0; i < all.size(); i++) {
+                int halfSize = all[i].size / 2;
+                for (int cy = cellOf(all[i].centerY - halfSize); cy <= cellOf(all[i].centerY + halfSize); cy++) {
+                    for (int cx = cellOf(all[i].centerX - halfSize); cx <= cellOf(all[i].centerX + halfSize); cx++) {
+                        visit(cx, cy, (int)i);
+                    }
+                }
+            }
+        };
+
+        if (range <= 4 * (long long)all.size()) {
+            std::vector<int> start(range + 1, 0);
+            forEachCell([&](int cx, int cy, int) { start[(cy - minY) * columns + (cx - minX) + 1]++; });
+            size_t used = 0;
+            for (long long c = 0; c < range; c++) {
+                used += start[c + 1] != 0;
+                start[c + 1] += start[c];
+            }
+            std::vector<int> sorted(start[range]);
+            std::vector<int> next(start.begin(), start.end() - 1);
+            forEachCell([&](int cx, int cy, int i) { sorted[next[(cy - minY) * columns + (cx - minX)]++] = i; });
+            cells.reserve(used);
+            for (long long c = 0; c < range; c++) {
+                if (start[c] == start[c + 1]) continue;
+                cells.emplace(key((int)(c % columns + minX), (int)(c / columns + minY)),
+                              std::vector<int>(sorted.begin() + start[c], sorted.begin() + start[c + 1]));
+            }
+            return;
+        }
+
+        std::vector<std::pair<long long, int>> entries;
+        forEachCell([&](int cx, int cy, int i) { entries.push_back(std::make_pair(key(cx, cy), i)); });
+        std::sort(entries.begin(), entries.end());
+        size_t used = 0;
+        for (size_t e = 0; e < entries.size(); e++) used += e == 0 || entries[e].first != entries[e - 1].first;
+        cells.reserve(used);
+        for (size_t e = 0; e < entries.size();) {
+            size_t end = e;
+            while (end < entries.size() && entries[end].first == entries[e].first) end++;
+            std::vector<int>& cell = cells[entries[e].first];
+            cell.reserve(end - e);
+            for (; e < end; e++) cell.push_back(entries[e].second);
+        }
+    }
+
+    void clear() {
+        cells.clear();
+        stamps.clear();
+    }
+
+    // Squares whose boxes overlap [xmin, xmax] x [ymin, ymax], in index order
+    void queryRect(const std::vector<SquareArc>& all, int xmin, int ymin, int xmax, int ymax,
+                   std::vector<int>& out) {
+        out.clear();
+        queryStamp++;
+        for (int cy = cellOf(ymin); cy <= cellOf(ymax); cy++) {
+            for (int cx = cellOf(xmin); cx <= cellOf(xmax); cx++) {
+                auto cell = cells.find(key(cx, cy));
+                if (cell == cells.end()) continue;
+                for (int i : cell->second) {
+                    if (stamps[i] == queryStamp) continue;
+                    stamps[i] = queryStamp;
+                    int halfSize = all[i].size / 2;
+                    if (all[i].centerX + halfSize < xmin || all[i].centerX - halfSize > xmax ||
+                        all[i].centerY + halfSize < ymin || all[i].centerY - halfSize > ymax) continue;
+                    out.push_back(i);
+                }
+            }
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+    // Topmost (last drawn) square containing (x, y), or -1
+    int queryPoint(const std::vector<SquareArc>& all, int x, int y) const {
+        auto cell = cells.find(key(cellOf(x), cellOf(y)));
+        if (cell == cells.end()) return -1;
+        for (auto it = cell->second.rbegin(); it != cell->second.rend(); ++it) {
+            if (squareContains(all[*it], x, y)) return *it;
+        }
+        return -1;
+    }
+};
+
 // Square storage
 std::vector<SquareArc> squares;
+SquareGrid squareGrid(64);
+std::vector<int> visibleSquares;
+int selectedSquare = -1;
 bool definingSquare = false;
 int squareStage = 0;
 int centerX, centerY, cornerX, cornerY;
 
-// Function to plot a pixel
-void drawPixel(int x, int y) {
-    glBegin(GL_POINTS);
-    glVertex2i(x, y);
-    glEnd();
-}
+// Arc pixels and edge lines of a whole frame are collected here and
+// drawn with one call each at the end of display()
+VertexBatch pointBatch(GL_POINTS);
+VertexBatch lineBatch(GL_LINES, 1 << 12);
+
+// Rasterized outline of one square: arc pixels and the endpoints of the
+// four edge lines, both as interleaved x, y pairs
+struct SquareRaster {
+    std::vector<GLint> points;
+    GLint edges[16];
+    bool valid = false;
+
+    size_t bytes() const {
+        return sizeof(SquareRaster) + points.capacity() * sizeof(GLint);
+    }
+};
+
+// Retained rasters, parallel to squares. A placed square never changes,
+// so it is rasterized on its first visible frame and replayed afterwards.
+// Setting valid = false forces a re-rasterization.
+std::vector<SquareRaster> rasterCache;
+size_t rasterCacheBytes = 0;
 
-// Midpoint circle algorithm to draw an arc
-void drawCircleArc(int centerX, int centerY, int radius, double startAngle, double endAngle) {
+// Midpoint circle algorithm to draw an arc; pixels are appended to out
+void drawCircleArc(int centerX, int centerY, int radius, double startAngle, double endAngle,
+                   std::vector<GLint>& out) {
     // Convert angles to range [0, 2π]
     while (startAngle < 0) startAngle += 2 * M_PI;
     while (endAngle < 0) endAngle += 2 * M_PI;
@@ -61,7 +237,8 @@ void drawCircleArc(int centerX, int centerY, int radius, double startAngle, doub
         bool inRange = (angleCopy >= startAngle && angleCopy <= endAngle);
         
         if (inRange) {
-            drawPixel(centerX + x, centerY + y);
+            out.push_back(centerX + x);
+            out.push_back(centerY + y);
         }
     };
     
@@ -86,8 +263,8 @@ void drawCircleArc(int centerX, int centerY, int radius, double startAngle, doub
     }
 }
 
-// Draw a square with four arcs at the corners
-void drawSquareWithArcs(int centerX, int centerY, int size) {
+// Rasterize a square with four arcs at the corners
+void rasterizeSquareWithArcs(int centerX, int centerY, int size, SquareRaster& raster) {
     int halfSize = size / 2;
     int cornerRadius = size / 4; // Radius of the arcs
     
@@ -104,26 +281,23 @@ void drawSquareWithArcs(int centerX, int centerY, int size) {
     int bottomRightX = centerX + halfSize;
     int bottomRightY = centerY - halfSize;
     
-    // Draw the square outline (without corners)
-    glBegin(GL_LINES);
-    
-    // Top line (excluding corners)
-    glVertex2i(topLeftX + cornerRadius, topLeftY);
-    glVertex2i(topRightX - cornerRadius, topRightY);
-    
-    // Right line (excluding corners)
-    glVertex2i(topRightX, topRightY - cornerRadius);
-    glVertex2i(bottomRightX, bottomRightY + cornerRadius);
-    
-    // Bottom line (excluding corners)
-    glVertex2i(bottomLeftX + cornerRadius, bottomLeftY);
-    glVertex2i(bottomRightX - cornerRadius, bottomRightY);
-    
-    // Left line (excluding corners)
-    glVertex2i(topLeftX, topLeftY - cornerRadius);
-    glVertex2i(bottomLeftX, bottomLeftY + cornerRadius);
-    
-    glEnd();
+    // Square outline (without corners)
+    const GLint edges[16] = {
+        // Top line (excluding corners)
+        topLeftX + cornerRadius, topLeftY,
+        topRightX - cornerRadius, topRightY,
+        // Right line (excluding corners)
+        topRightX, topRightY - cornerRadius,
+        bottomRightX, bottomRightY + cornerRadius,
+        // Bottom line (excluding corners)
+        bottomLeftX + cornerRadius, bottomLeftY,
+        bottomRightX - cornerRadius, bottomRightY,
+        // Left line (excluding corners)
+        topLeftX, topLeftY - cornerRadius,
+        bottomLeftX, bottomLeftY + cornerRadius,
+    };
+    std::copy(edges, edges + 16, raster.edges);
+    raster.points.clear();
     
     // Draw the four arcs at the corners
     
@@ -131,29 +305,201 @@ void drawSquareWithArcs(int centerX, int centerY, int size) {
     drawCircleArc(
         topLeftX + cornerRadius, topLeftY - cornerRadius, // Arc center
         cornerRadius,
-        M_PI, 3 * M_PI / 2 // Start at left (π), end at top (3π/2)
+        M_PI, 3 * M_PI / 2, // Start at left (π), end at top (3π/2)
+        raster.points
     );
     
     // Top-right corner arc
     drawCircleArc(
         topRightX - cornerRadius, topRightY - cornerRadius, // Arc center
         cornerRadius,
-        3 * M_PI / 2, 2 * M_PI // Start at top (3π/2), end at right (2π)
+        3 * M_PI / 2, 2 * M_PI, // Start at top (3π/2), end at right (2π)
+        raster.points
     );
     
     // Bottom-right corner arc
     drawCircleArc(
         bottomRightX - cornerRadius, bottomRightY + cornerRadius, // Arc center
         cornerRadius,
-        0, M_PI / 2 // Start at right (0), end at bottom (π/2)
+        0, M_PI / 2, // Start at right (0), end at bottom (π/2)
+        raster.points
     );
     
     // Bottom-left corner arc
     drawCircleArc(
         bottomLeftX + cornerRadius, bottomLeftY + cornerRadius, // Arc center
         cornerRadius,
-        M_PI / 2, M_PI // Start at bottom (π/2), end at left (π)
+        M_PI / 2, M_PI, // Start at bottom (π/2), end at left (π)
+        raster.points
     );
+    raster.valid = true;
+}
+
+// Queue a rasterized square for this frame's batched draw calls
+void submitSquare(const SquareRaster& raster) {
+    lineBatch.add(raster.edges, 8);
+    pointBatch.add(raster.points.data(), (int)raster.points.size() / 2);
+}
+
+// Outline stamps keyed by size: the raster of a square centered on the
+// origin. Every arc center is an integer offset from the square center, so
+// any square of that size is its stamp translated, pixel for pixel. Sizes
+// are unbounded, so the stamps share a byte budget; a stamp that would
+// exceed it drops the others, which are rebuilt when next needed.
+const size_t STAMP_CACHE_BUDGET = 4 << 20;
+std::unordered_map<int, SquareRaster> stampCache;
+size_t stampCacheBytes = 0;
+
+void clearStampCache() {
+    stampCache.clear();
+    stampCacheBytes = 0;
+}
+
+const SquareRaster& squareStamp(int size) {
+    auto found = stampCache.find(size);
+    if (found != stampCache.end()) return found->second;
+    SquareRaster stamp;
+    rasterizeSquareWithArcs(0, 0, size, stamp);
+    stamp.points.shrink_to_fit();
+    if (stampCacheBytes + stamp.bytes() > STAMP_CACHE_BUDGET) clearStampCache();
+    stampCacheBytes += stamp.bytes();
+    return stampCache[size] = std::move(stamp);
+}
+
+// Place the stamp of a size at (centerX, centerY)
+void stampSquare(int centerX, int centerY, int size, SquareRaster& raster) {
+    const SquareRaster& stamp = squareStamp(size);
+    for (int k = 0; k < 16; k += 2) {
+        raster.edges[k] = stamp.edges[k] + centerX;
+        raster.edges[k + 1] = stamp.edges[k + 1] + centerY;
+    }
+    size_t n = stamp.points.size();
+    raster.points.resize(n);
+    const GLint* src = stamp.points.data();
+    GLint* dst = raster.points.data();
+    for (size_t k = 0; k < n; k += 2) {
+        dst[k] = src[k] + centerX;
+        dst[k + 1] = src[k + 1] + centerY;
+    }
+    raster.valid = true;
+}
+
+// Draw a square that is not in the cache (the one being defined)
+void drawSquareWithArcs(int centerX, int centerY, int size) {
+    static SquareRaster scratch;
+    stampSquare(centerX, centerY, size, scratch);
+    submitSquare(scratch);
+}
+
+// Cached raster of square i, stamped on first use
+const SquareRaster& cachedRaster(int i) {
+    if (rasterCache.size() < squares.size()) rasterCache.resize(squares.size());
+    SquareRaster& raster = rasterCache[i];
+    if (!raster.valid) {
+        size_t before = raster.bytes();
+        stampSquare(squares[i].centerX, squares[i].centerY, squares[i].size, raster);
+        rasterCacheBytes += raster.bytes() - before;
+    }
+    return raster;
+}
+
+void clearRasterCache() {
+    rasterCache.clear();
+    rasterCache.shrink_to_fit();
+    rasterCacheBytes = 0;
+}
+
+// Damage tracking for the preview. While a square is being defined, the
+// last full frame minus the preview is kept as a snapshot; a mouse move
+// then only restores the old and new preview boxes from it and draws the
+// new preview, so its cost does not depend on how many squares exist.
+struct DirtyRect {
+    int xmin = 0, ymin = 0, xmax = -1, ymax = -1;
+
+    bool empty() const { return xmin > xmax || ymin > ymax; }
+
+    void add(const DirtyRect& other) {
+        if (other.empty()) return;
+        if (empty()) { *this = other; return; }
+        xmin = std::min(xmin, other.xmin);
+        ymin = std::min(ymin, other.ymin);
+        xmax = std::max(xmax, other.xmax);
+        ymax = std::max(ymax, other.ymax);
+    }
+};
+
+std::vector<GLubyte> previewBackground;
+bool previewBackgroundValid = false;
+DirtyRect previewBox;
+
+int previewSize() {
+    return sqrt(pow(centerX - cornerX, 2) + pow(centerY - cornerY, 2)) * 2;
+}
+
+// Window pixels touched by a square, with a margin for the 2-pixel points
+DirtyRect squareBounds(int cx, int cy, int size) {
+    const int MARGIN = 2;
+    DirtyRect r;
+    r.xmin = std::max(cx - size / 2 - MARGIN, 0);
+    r.ymin = std::max(cy - size / 2 - MARGIN, 0);
+    r.xmax = std::min(cx + size / 2 + MARGIN, WINDOW_WIDTH - 1);
+    r.ymax = std::min(cy + size / 2 + MARGIN, WINDOW_HEIGHT - 1);
+    return r;
+}
+
+// Redraw only the damaged region, straight into the front buffer. The
+// back buffer is stale afterwards, but the next full frame repaints it.
+void redrawPreview() {
+    DirtyRect box = squareBounds(centerX, centerY, previewSize());
+    DirtyRect dirty = previewBox;
+    dirty.add(box);
+    
+    glDrawBuffer(GL_FRONT);
+    if (!dirty.empty()) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, WINDOW_WIDTH);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, dirty.xmin);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, dirty.ymin);
+        glRasterPos2i(dirty.xmin, dirty.ymin);
+        glDrawPixels(dirty.xmax - dirty.xmin + 1, dirty.ymax - dirty.ymin + 1,
+                     GL_RGB, GL_UNSIGNED_BYTE, previewBackground.data());
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    }
+    glColor3f(1.0f, 1.0f, 1.0f);
+    drawSquareWithArcs(centerX, centerY, previewSize());
+    lineBatch.endFrame();
+    pointBatch.endFrame();
+    glFlush();
+    glDrawBuffer(GL_BACK);
+    previewBox = box;
+}
+
+// Placed squares are saved as they are added: one record of centerX,
+// centerY, size per square
+SceneFile sceneFile;
+const uint32_t SCENE_FIELDS = 3;
+
+void saveSquare(const SquareArc& square) {
+    if (!sceneFile.isOpen()) return;
+    const int32_t record[SCENE_FIELDS] = { square.centerX, square.centerY, square.size };
+    sceneFile.append(record);
+}
+
+// Replaces the squares with the contents of the open scene file
+void loadScene() {
+    squares.clear();
+    squareGrid.clear();
+    clearRasterCache();
+    selectedSquare = -1;
+    uint32_t count = sceneFile.count();
+    const int32_t* xs = sceneFile.field(0);
+    const int32_t* ys = sceneFile.field(1);
+    const int32_t* sizes = sceneFile.field(2);
+    squares.reserve(count);
+    for (uint32_t i = 0; i < count; i++) squares.push_back(SquareArc(xs[i], ys[i], sizes[i]));
+    squareGrid.build(squares);
 }
 
 // Display callback function
@@ -161,15 +507,54 @@ void display() {
     glClear(GL_COLOR_BUFFER_BIT);
     glColor3f(1.0f, 1.0f, 1.0f);
     
-    // Draw all saved squares with arcs
-    for (const auto& square : squares) {
-        drawSquareWithArcs(square.centerX, square.centerY, square.size);
+    // Draw the saved squares that intersect the window
+    squareGrid.queryRect(squares, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, visibleSquares);
+    size_t cachedBytes = rasterCacheBytes, stampBytes = stampCacheBytes;
+    for (int i : visibleSquares) {
+        if (i == selectedSquare) continue;
+        submitSquare(cachedRaster(i));
+    }
+    
+    // Draw the selected square on top in yellow
+    if (selectedSquare >= 0) {
+        lineBatch.flush();
+        pointBatch.flush();
+        glColor3f(1.0f, 1.0f, 0.0f);
+        submitSquare(cachedRaster(selectedSquare));
+        lineBatch.flush();
+        pointBatch.flush();
+        glColor3f(1.0f, 1.0f, 1.0f);
+    }
+    
+    // Draw the square being defined, after keeping a snapshot of the
+    // frame without it for redrawPreview()
+    previewBackgroundValid = false;
+    previewBox = DirtyRect();
+    if (definingSquare) {
+        lineBatch.flush();
+        pointBatch.flush();
+        previewBackground.resize((size_t)WINDOW_WIDTH * WINDOW_HEIGHT * 3);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadBuffer(GL_BACK);
+        glReadPixels(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, GL_RGB, GL_UNSIGNED_BYTE,
+                     previewBackground.data());
+        previewBackgroundValid = true;
+        
+        drawSquareWithArcs(centerX, centerY, previewSize());
+        previewBox = squareBounds(centerX, centerY, previewSize());
     }
     
-    // Draw the square being defined
-    if (definingSquare && squareStage >= 2) {
-        int size = sqrt(pow(centerX - cornerX, 2) + pow(centerY - cornerY, 2)) * 2;
-        drawSquareWithArcs(centerX, centerY, size);
+    // Submit the frame: one draw call for all lines, one for all pixels
+    bool changed = lineBatch.endFrame();
+    changed = pointBatch.endFrame() || changed;
+    if (changed) {
+        std::cout << "Frame: " << pointBatch.frameVertices << " pixels, "
+                  << pointBatch.frameDrawCalls + lineBatch.frameDrawCalls << " draw calls" << std::endl;
+    }
+    if (rasterCacheBytes != cachedBytes || stampCacheBytes != stampBytes) {
+        std::cout << "Raster cache: " << rasterCache.size() << " squares, "
+                  << rasterCacheBytes / 1024.0 << " KiB, " << stampCache.size() << " stamps, "
+                  << stampCacheBytes / 1024.0 << " KiB" << std::endl;
     }
     
     glutSwapBuffers();
@@ -192,6 +577,8 @@ void mouse(int button, int state, int x, int y) {
             squareStage = 1;
             centerX = x;
             centerY = y;
+            cornerX = x;
+            cornerY = y;
         } else {
             squareStage++;
             
@@ -199,15 +586,25 @@ void mouse(int button, int state, int x, int y) {
                 // Define square size based on distance from center to corner
                 cornerX = x;
                 cornerY = y;
-                int size = sqrt(pow(centerX - cornerX, 2) + pow(centerY - cornerY, 2)) * 2;
                 
                 // Complete the square definition
-                squares.push_back(SquareArc(centerX, centerY, size));
+                squares.push_back(SquareArc(centerX, centerY, previewSize()));
+                squareGrid.insert(squares.back(), (int)squares.size() - 1);
+                saveSquare(squares.back());
                 definingSquare = false;
                 squareStage = 0;
             }
         }
         
+        glutPostRedisplay();
+    } else if (button == GLUT_RIGHT_BUTTON && state == GLUT_DOWN) {
+        // Select the topmost square under the cursor
+        selectedSquare = squareGrid.queryPoint(squares, x, y);
+        if (selectedSquare >= 0) {
+            const SquareArc& square = squares[selectedSquare];
+            std::cout << "Selected square " << selectedSquare << " at (" << square.centerX << ", "
+                      << square.centerY << "), size " << square.size << std::endl;
+        }
         glutPostRedisplay();
     }
 }
@@ -220,7 +617,12 @@ void motion(int x, int y) {
     if (definingSquare && squareStage == 1) {
         cornerX = x;
         cornerY = y;
-        glutPostRedisplay();
+        // Only the preview moved: repaint its old and new boxes
+        if (previewBackgroundValid) {
+            redrawPreview();
+        } else {
+            glutPostRedisplay();
+        }
     }
 }
 
@@ -231,6 +633,10 @@ void keyboard(unsigned char key, int x, int y) {
     } else if (key == 'c' || key == 'C') {
         // Clear all squares
         squares.clear();
+        squareGrid.clear();
+        clearRasterCache();
+        sceneFile.clear();
+        selectedSquare = -1;
         definingSquare = false;
         squareStage = 0;
         glutPostRedisplay();
@@ -246,8 +652,201 @@ void init() {
     glPointSize(2.0f);
 }
 
+// Headless mode: ./output --bench measures the grid index on a large layout
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int runBenchmark() {
+    const int COUNT = 200000, WORLD = 40000, QUERIES = 100000;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> position(0, WORLD), size(8, 96);
+    squares.clear();
+    for (int i = 0; i < COUNT; i++) squares.push_back(SquareArc(position(rng), position(rng), size(rng)));
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < COUNT; i++) squareGrid.insert(squares[i], i);
+    printf("%d squares in a %dx%d world, grid built in %.2f ms\n", COUNT, WORLD, WORLD,
+           secondsSince(start) * 1e3);
+
+    // Viewport culling: the window placed at random spots of the world
+    const int VIEWS = 1000;
+    std::vector<int> viewX(VIEWS), viewY(VIEWS);
+    for (int v = 0; v < VIEWS; v++) { viewX[v] = position(rng); viewY[v] = position(rng); }
+    size_t found = 0, scanned = 0;
+    start = std::chrono::steady_clock::now();
+    for (int v = 0; v < VIEWS; v++) {
+        int x = viewX[v], y = viewY[v];
+        squareGrid.queryRect(squares, x, y, x + WINDOW_WIDTH, y + WINDOW_HEIGHT, visibleSquares);
+        found += visibleSquares.size();
+    }
+    double grid = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    for (int v = 0; v < VIEWS; v++) {
+        int x = viewX[v], y = viewY[v];
+        for (const SquareArc& square : squares) {
+            int halfSize = square.size / 2;
+            scanned += !(square.centerX + halfSize < x || square.centerX - halfSize > x + WINDOW_WIDTH ||
+                         square.centerY + halfSize < y || square.centerY - halfSize > y + WINDOW_HEIGHT);
+        }
+    }
+    double linear = secondsSince(start);
+    printf("viewport cull: grid %.3f us/query, linear scan %.3f us/query (%zu vs %zu visible)\n",
+           grid / VIEWS * 1e6, linear / VIEWS * 1e6, found, scanned);
+
+    // Point selection
+    std::vector<int> px(QUERIES), py(QUERIES);
+    for (int q = 0; q < QUERIES; q++) { px[q] = position(rng); py[q] = position(rng); }
+    int hits = 0, linearHits = 0, mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    std::vector<int> picked(QUERIES);
+    for (int q = 0; q < QUERIES; q++) {
+        picked[q] = squareGrid.queryPoint(squares, px[q], py[q]);
+        hits += picked[q] >= 0;
+    }
+    grid = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < QUERIES / 100; q++) {
+        int top = -1;
+        for (int i = COUNT - 1; i >= 0 && top < 0; i--) {
+            if (squareContains(squares[i], px[q], py[q])) top = i;
+        }
+        linearHits += top >= 0;
+        mismatches += top != picked[q];
+    }
+    linear = secondsSince(start) * 100;
+    printf("point query: grid %.3f us/query, linear scan %.3f us/query, %d hits, %d mismatches\n",
+           grid / QUERIES * 1e6, linear / QUERIES * 1e6, hits, mismatches);
+
+    // Retained rasters: frames of a static window-sized scene, rasterized
+    // every frame versus replayed from the cache. Only the vertex stream is
+    // built here; the GL submit is the same in both cases.
+    const int SCENE = 2000, FRAMES = 50;
+    std::uniform_int_distribution<int> screenX(0, WINDOW_WIDTH), screenY(0, WINDOW_HEIGHT);
+    squares.clear();
+    squareGrid.clear();
+    for (int i = 0; i < SCENE; i++) {
+        squares.push_back(SquareArc(screenX(rng), screenY(rng), size(rng)));
+        squareGrid.insert(squares.back(), i);
+    }
+    std::vector<GLint> stream;
+    SquareRaster scratch;
+    size_t immediatePixels = 0, cachedPixels = 0;
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++) {
+        stream.clear();
+        squareGrid.queryRect(squares, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, visibleSquares);
+        for (int i : visibleSquares) {
+            rasterizeSquareWithArcs(squares[i].centerX, squares[i].centerY, squares[i].size, scratch);
+            stream.insert(stream.end(), scratch.points.begin(), scratch.points.end());
+        }
+        immediatePixels += stream.size() / 2;
+    }
+    double immediate = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    for (int f = 0; f < FRAMES; f++) {
+        stream.clear();
+        squareGrid.queryRect(squares, 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT, visibleSquares);
+        for (int i : visibleSquares) {
+            const SquareRaster& raster = cachedRaster(i);
+            stream.insert(stream.end(), raster.points.begin(), raster.points.end());
+        }
+        cachedPixels += stream.size() / 2;
+    }
+    double cached = secondsSince(start);
+    printf("%d squares/frame: rasterize %.3f ms/frame, cached %.3f ms/frame (%zu vs %zu pixels), "
+           "cache %.1f KiB\n", SCENE, immediate / FRAMES * 1e3, cached / FRAMES * 1e3,
+           immediatePixels, cachedPixels, rasterCacheBytes / 1024.0);
+
+    // Instance throughput: per-instance rasterization versus placing the
+    // size's stamp. Every stamped instance is checked against the direct one.
+    const int INSTANCES = 20000;
+    std::vector<SquareArc> instances;
+    for (int i = 0; i < INSTANCES; i++) instances.push_back(SquareArc(position(rng), position(rng), size(rng)));
+    std::vector<SquareRaster> direct(INSTANCES), stamped(INSTANCES);
+    clearStampCache();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < INSTANCES; i++) {
+        rasterizeSquareWithArcs(instances[i].centerX, instances[i].centerY, instances[i].size, direct[i]);
+    }
+    double rasterized = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < INSTANCES; i++) {
+        stampSquare(instances[i].centerX, instances[i].centerY, instances[i].size, stamped[i]);
+    }
+    double placed = secondsSince(start);
+    int stampMismatches = 0;
+    for (int i = 0; i < INSTANCES; i++) {
+        stampMismatches += direct[i].points != stamped[i].points ||
+                           !std::equal(direct[i].edges, direct[i].edges + 16, stamped[i].edges);
+    }
+    printf("%d instances: rasterize %.1fk/s, stamp %.1fk/s (%zu stamps, %.1f KiB, incl. build), "
+           "%d mismatches\n", INSTANCES, INSTANCES / rasterized / 1e3, INSTANCES / placed / 1e3,
+           stampCache.size(), stampCacheBytes / 1024.0, stampMismatches);
+
+    // A preview dragged through sizes up to 20000 stays within budget
+    size_t peakStampBytes = 0;
+    for (int s = 1; s <= 20000; s += 16) {
+        squareStamp(s);
+        peakStampBytes = std::max(peakStampBytes, stampCacheBytes);
+    }
+    printf("stamps for sizes 1..20000: peak %.1f KiB of a %.1f KiB budget\n", peakStampBytes / 1024.0,
+           STAMP_CACHE_BUDGET / 1024.0);
+    clearStampCache();
+
+    // Scene file: write a million squares, then time reopening the file.
+    // Opening counts until the scene can be drawn and picked, i.e. the
+    // mmap plus rebuilding the square list and grid from the mapped arrays.
+    const int SCENE_COUNT = 1000000;
+    const char* scenePath = "bench.scene";
+    std::vector<int32_t> columnX(SCENE_COUNT), columnY(SCENE_COUNT), columnSize(SCENE_COUNT);
+    for (int i = 0; i < SCENE_COUNT; i++) {
+        columnX[i] = position(rng);
+        columnY[i] = position(rng);
+        columnSize[i] = size(rng);
+    }
+    const int32_t* columns[SCENE_FIELDS] = { columnX.data(), columnY.data(), columnSize.data() };
+    std::remove(scenePath);
+    start = std::chrono::steady_clock::now();
+    if (!sceneFile.open(scenePath, SCENE_FIELDS) || !sceneFile.appendBulk(columns, SCENE_COUNT)) return 1;
+    sceneFile.close();
+    double written = secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    if (!sceneFile.open(scenePath, SCENE_FIELDS)) return 1;
+    double opened = secondsSince(start);
+    loadScene();
+    double loaded = secondsSince(start);
+    // Incremental saves into a fresh file, one record at a time, growing
+    // from the initial capacity
+    sceneFile.close();
+    std::remove(scenePath);
+    start = std::chrono::steady_clock::now();
+    if (!sceneFile.open(scenePath, SCENE_FIELDS)) return 1;
+    for (int i = 0; i < SCENE_COUNT; i++) saveSquare(squares[i]);
+    double appended = secondsSince(start);
+    bool same = sceneFile.count() == (uint32_t)SCENE_COUNT;
+    for (uint32_t f = 0; f < SCENE_FIELDS && same; f++) {
+        same = memcmp(sceneFile.field(f), columns[f], SCENE_COUNT * sizeof(int32_t)) == 0;
+    }
+    sceneFile.close();
+    std::remove(scenePath);
+    printf("%d-square scene: write %.1f ms, open %.1f ms (mmap %.3f ms, squares and grid the rest), "
+           "append %.1f ns/square, round trip %s\n", SCENE_COUNT, written * 1e3, loaded * 1e3,
+           opened * 1e3, appended / SCENE_COUNT * 1e9, same ? "ok" : "MISMATCH");
+    return 0;
+}
+
 int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) return runBenchmark();
+
     glutInit(&argc, argv);
+    
+    // The scene file is the first argument left after GLUT takes its own
+    const char* scenePath = argc > 1 ? argv[1] : "squares.scene";
+    if (sceneFile.open(scenePath, SCENE_FIELDS)) {
+        loadScene();
+        std::cout << "Loaded " << squares.size() << " squares from " << scenePath << std::endl;
+    }
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
     glutInitWindowPosition(100, 100);
@@ -265,7 +864,9 @@ int main(int argc, char** argv) {
     std::cout << "Square with Four Arcs Demo" << std::endl;
     std::cout << "1. Click to set the center of the square" << std::endl;
     std::cout << "2. Click to set the size of the square" << std::endl;
+    std::cout << "Right-click a square to select it" << std::endl;
     std::cout << "Press 'C' to clear all squares" << std::endl;
+    std::cout << "Squares are saved to the scene file as they are placed" << std::endl;
     std::cout << "Press 'ESC' to exit" << std::endl;
     
     glutMainLoop();
@@ -0,0 +1,66 @@
+#ifndef VERTEX_BATCH_H
+#define VERTEX_BATCH_H
+
+#include <GL/gl.h>
+#include <cstddef>
+#include <vector>
+
+// Accumulates 2D integer vertices of one primitive type (GL_POINTS,
+// GL_LINES, ...) and submits them with a single glDrawArrays call instead
+// of one glBegin/glEnd pair per primitive. The buffer is reserved once
+// and reused, so steady-state frames do not allocate.
+class VertexBatch {
+public:
+    explicit VertexBatch(GLenum primitive, size_t reserveVertices = 1 << 16)
+        : mode(primitive) {
+        coords.reserve(reserveVertices * 2);
+    }
+
+    void add(int x, int y) {
+        coords.push_back(x);
+        coords.push_back(y);
+    }
+
+    // Appends n vertices stored as interleaved x, y pairs
+    void add(const GLint* xy, size_t n) {
+        coords.insert(coords.end(), xy, xy + n * 2);
+    }
+
+    size_t pending() const { return coords.size() / 2; }
+
+    // Draws everything collected so far. Call it before changing any GL
+    // state (color, point size, viewport) that the vertices depend on.
+    void flush() {
+        if (coords.empty()) return;
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glVertexPointer(2, GL_INT, 0, coords.data());
+        glDrawArrays(mode, 0, (GLsizei)pending());
+        glDisableClientState(GL_VERTEX_ARRAY);
+        vertices += pending();
+        drawCalls++;
+        coords.clear();
+    }
+
+    // Flushes and closes the frame. Returns true when the vertex or draw
+    // call count differs from the previous frame.
+    bool endFrame() {
+        flush();
+        bool changed = vertices != frameVertices || drawCalls != frameDrawCalls;
+        frameVertices = vertices;
+        frameDrawCalls = drawCalls;
+        vertices = drawCalls = 0;
+        return changed;
+    }
+
+    // Totals of the last completed frame
+    size_t frameVertices = 0;
+    size_t frameDrawCalls = 0;
+
+private:
+    GLenum mode;
+    std::vector<GLint> coords;
+    size_t vertices = 0;
+    size_t drawCalls = 0;
+};
+
+#endif